@@ -0,0 +1,168 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Coût des alarmes à pleine capacité (ALARM_CAPACITY) : AlarmHeap push / pop / remove, puis AlarmScheduler::run()
+// sur une horloge simulée comme test_alarm, avec la latence de la tâche esp_timer, la durée des rappels et une
+// correction de phase par seconde (Application::slew()). Affiche les opérations par seconde et la distribution
+// du retard des déclenchements sur l'heure disciplinée.
+// Usage : bench_alarm [opérations] [heures simulées]
+
+#include "alarm.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define ALARM_CAPACITY 1024                 // comme application.h
+#define START    1750000000000000ULL        // [µs depuis 1970]
+#define LATENCY  40.0                       // latence moyenne de la tâche esp_timer [µs]
+#define CALLBACK 3                          // durée d'un rappel [µs]
+#define SLEW     50                         // correction de phase maximale par seconde [µs]
+
+static int64_t  T = 0;              // Temps de l'esp_timer [µs].
+static uint64_t offset = START;     // Horloge disciplinée = offset + T.
+static int64_t  deadline = -1;
+static void   (*expire)(void*) = nullptr;
+static void*    expireArg = nullptr;
+
+ESP32Time::ESP32Time(unsigned long) {}
+void ESP32Time::setTime(unsigned long epoch, int micros) { offset = uint64_t(epoch) * 1000000 + micros - T; }
+unsigned long ESP32Time::getEpoch() { return (offset + T) / 1000000; }
+long ESP32Time::getMicros() { return (offset + T) % 1000000; }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int64_t esp_timer_get_time() { return T; }
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  expire = args->callback;
+  expireArg = args->arg;
+  *handle = (esp_timer_handle_t)1;
+  return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t timeout) { deadline = T + timeout; return ESP_OK; }
+esp_err_t esp_timer_stop(esp_timer_handle_t) { deadline = -1; return ESP_OK; }
+
+static std::mt19937 rng(1);
+static std::vector<int64_t> late;   // Retard de chaque déclenchement [µs], négatif en avance.
+
+static void onAlarm(Alarm& alarm) {
+  late.push_back(int64_t(offset + T) - int64_t(alarm.when - uint64_t(alarm.period) * 1000000));
+  T += CALLBACK;
+}
+
+static double elapsed(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// AlarmHeap plein : pop + push d'une échéance plus lointaine, puis remove + push d'une alarme au hasard.
+static void benchHeap(const unsigned operations) {
+  std::vector<Alarm> alarms(ALARM_CAPACITY);
+  Alarm* slots[ALARM_CAPACITY];
+  AlarmHeap heap(slots, ALARM_CAPACITY);
+  std::uniform_int_distribution<uint64_t> spread(0, 3600000000ULL);
+  for (auto& alarm : alarms) {
+    alarm.when = spread(rng);
+    heap.push(alarm);
+  }
+  Alarm extra;
+  std::printf("capacité %u, push au-delà : %s\n", ALARM_CAPACITY, heap.push(extra) ? "accepté" : "refusé");
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < operations; ++i) {
+    Alarm* const alarm = heap.pop();
+    alarm->when += spread(rng);
+    heap.push(*alarm);
+  }
+  double s = elapsed(start);
+  std::printf("pop + push     : %6.1f ns (%5.1f M/s)\n", s * 1e9 / operations, operations / s / 1e6);
+
+  std::vector<size_t> picks(operations);
+  std::uniform_int_distribution<size_t> pick(0, ALARM_CAPACITY - 1);
+  for (auto& p : picks) p = pick(rng);
+  start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < operations; ++i) {
+    Alarm& alarm = alarms[picks[i]];
+    heap.remove(alarm);
+    heap.push(alarm);
+  }
+  s = elapsed(start);
+  std::printf("remove + push  : %6.1f ns (%5.1f M/s)\n", s * 1e9 / operations, operations / s / 1e6);
+}
+
+// AlarmScheduler plein d'alarmes périodiques sur l'horloge simulée.
+static void benchScheduler(const double hours) {
+  static const uint32_t periods[] = { 1, 2, 5, 10, 30, 60 };
+  std::vector<Alarm> alarms(ALARM_CAPACITY);
+  Alarm* slots[ALARM_CAPACITY];
+  ESP32Time time;
+  AlarmScheduler scheduler(time, slots, ALARM_CAPACITY);
+  scheduler.begin();
+  std::uniform_int_distribution<uint64_t> phase(1000000, 60000000);
+  for (size_t i = 0; i < alarms.size(); ++i) {
+    alarms[i].callback = onAlarm;
+    scheduler.schedule(alarms[i], START + phase(rng), periods[i % 6]);
+  }
+
+  std::exponential_distribution<double> latency(1 / LATENCY);
+  std::uniform_int_distribution<int> slew(-SLEW, SLEW);
+  const int64_t end = int64_t(hours * 3600e6);
+  int64_t second = 1000000;
+  unsigned timers = 0;
+  const auto start = std::chrono::steady_clock::now();
+  while (T < end) {
+    if ((deadline >= 0) && (deadline <= second)) {
+      T = deadline + int64_t(latency(rng));
+      deadline = -1;
+      ++timers;
+      expire(expireArg);
+      continue;
+    }
+    T = second;       // correction de phase, comme Application::slew().
+    time.setTime(time.getEpoch(), time.getMicros() + slew(rng));
+    scheduler.rearm();
+    second += 1000000;
+  }
+  const double s = elapsed(start);
+
+  std::printf("\n%u alarmes sur %.1f h simulées : %zu déclenchements, %u réveils du timer\n", ALARM_CAPACITY, hours,
+    late.size(), timers);
+  std::printf("run()          : %6.1f ns par alarme (%5.2f M/s, simulation comprise)\n", s * 1e9 / late.size(),
+    late.size() / s / 1e6);
+
+  std::sort(late.begin(), late.end());
+  const auto at = [](const double q) { return late[size_t(q * (late.size() - 1))]; };
+  std::printf("retard [us]    : min %lld  p50 %lld  p90 %lld  p99 %lld  p99.9 %lld  max %lld\n", (long long)late.front(),
+    (long long)at(0.5), (long long)at(0.9), (long long)at(0.99), (long long)at(0.999), (long long)late.back());
+  const int64_t bounds[] = { 0, 10, 100, 1000, 10000 };
+  size_t previous = 0;
+  for (const int64_t bound : bounds) {
+    const size_t n = std::lower_bound(late.begin(), late.end(), bound) - late.begin();
+    std::printf("  < %6lld us : %6.2f %%\n", (long long)bound, 100.0 * (n - previous) / late.size());
+    previous = n;
+  }
+  std::printf("  >= %5d us : %6.2f %%\n", 10000, 100.0 * (late.size() - previous) / late.size());
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned operations = argc > 1 ? std::atoi(argv[1]) : 5000000;
+  const double hours = argc > 2 ? std::atof(argv[2]) : 1;
+  benchHeap(operations);
+  benchScheduler(hours);
+  return 0;
+}
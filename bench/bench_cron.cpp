@@ -0,0 +1,127 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Coût de CronExpression : compilation de quelques milliers d'expressions variées (intervalles, pas, règle OU
+// jour du mois / jour de la semaine, mois creux comme "0 0 29 2 *", noms), puis nextFire() depuis des instants
+// répartis sur l'année 2026 du fuseau de application.cpp, resserrés autour des deux changements d'heure.
+// Usage : bench_cron [expressions]
+
+#include "cron.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+static TimeChangeRule frSTD = {"CET", Last, Sun, Mar, 2, +120};
+static TimeChangeRule frDST = {"CEST", Last, Sun, Oct, 3, +60};
+static const Timezone paris(frSTD, frDST);
+
+#define YEAR2026 1767225600   // 2026-01-01 00:00 UTC
+#define YEAR2027 1798761600   // 2027-01-01 00:00 UTC
+#define SPRING   1774749600   // 2026-03-29 02:00 UTC
+#define AUTUMN   1792897200   // 2026-10-25 03:00 UTC
+#define HOUR     3600
+
+static const char* const kinds[] = { "intervalles", "pas", "jour OU semaine", "mois creux", "noms" };
+#define KINDS 5
+
+static std::mt19937 rng(1);
+
+static int pick(const int min, const int max) {
+  return std::uniform_int_distribution<int>(min, max)(rng);
+}
+
+// Expression aléatoire de la catégorie kind.
+static std::string generate(const int kind) {
+  static const char* const weekdays[] = { "MON-FRI", "SAT,SUN", "MON", "FRI", "0", "1-5", "TUE,THU", "7" };
+  static const char* const months[] = { "JAN", "FEB", "MAR-MAY", "JUN,JUL,AUG", "OCT", "NOV-DEC", "*/3", "2-11/2" };
+  static const char* const sparse[] = { "0 0 29 2 *", "30 12 29 FEB *", "0 0 31 * *", "15 6 30 1-12/3 *",
+    "0 0 1 JAN *", "59 23 31 DEC *", "0 12 13 * FRI", "0 0 30 2 *" };
+  char buffer[64];
+  switch (kind) {
+    case 0: {
+      const int m = pick(0, 58), h = pick(0, 22);
+      snprintf(buffer, sizeof(buffer), "%d-%d %d-%d * * *", m, pick(m + 1, 59), h, pick(h + 1, 23));
+      break;
+    }
+    case 1:
+      if (pick(0, 1)) snprintf(buffer, sizeof(buffer), "*/%d */%d * * *", pick(1, 30), pick(1, 12));
+      else snprintf(buffer, sizeof(buffer), "%d-59/%d %d-23/%d * * *", pick(0, 10), pick(5, 20), pick(0, 5), pick(2, 6));
+      break;
+    case 2:
+      snprintf(buffer, sizeof(buffer), "%d %d %d,%d * %s", pick(0, 59), pick(0, 23), pick(1, 14), pick(15, 31),
+        weekdays[pick(0, 7)]);
+      break;
+    case 3:
+      return sparse[pick(0, 7)];
+    default:
+      snprintf(buffer, sizeof(buffer), "%d %d * %s %s", pick(0, 59), pick(0, 23), months[pick(0, 7)], weekdays[pick(0, 7)]);
+      break;
+  }
+  return buffer;
+}
+
+int main(int argc, char* argv[]) {
+  setenv("TZ", "UTC", 1);   // Timezone calcule les changements avec mktime(), en UTC comme sur l'ESP32.
+  tzset();
+  const int count = argc > 1 ? std::atoi(argv[1]) : 4000;
+
+  std::vector<std::string> texts(count);
+  for (int i = 0; i < count; ++i) texts[i] = generate(i % KINDS);
+
+  std::vector<CronExpression> expressions(count);
+  auto start = std::chrono::steady_clock::now();
+  int invalid = 0;
+  for (int i = 0; i < count; ++i) invalid += !expressions[i].compile(texts[i].c_str());
+  const double compile = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%d expressions compilées en %.0f ns chacune, %d invalides\n", count, compile / count, invalid);
+
+// Instants de départ : toutes les 23 h 13 min sur l'année, et toutes les 5 min autour des changements d'heure.
+  std::vector<time_t> starts;
+  for (time_t t = YEAR2026; t < YEAR2027; t += 23 * HOUR + 13 * 60) starts.push_back(t);
+  for (const time_t change : { SPRING, AUTUMN }) {
+    for (time_t t = change - 2 * HOUR; t < change + 2 * HOUR; t += 5 * 60) starts.push_back(t);
+  }
+
+  std::vector<double> times[KINDS];
+  unsigned never[KINDS] = {}, wrong[KINDS] = {};
+  for (int i = 0; i < count; ++i) {
+    const int kind = i % KINDS;
+    for (const time_t after : starts) {
+      start = std::chrono::steady_clock::now();
+      const time_t next = expressions[i].nextFire(after, paris);
+      times[kind].push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+      if (!next) ++never[kind];
+      else if (next <= after) ++wrong[kind];
+    }
+  }
+
+  std::printf("nextFire() depuis %zu instants de 2026 par expression :\n", starts.size());
+  std::printf("%-16s %10s %10s %10s %10s %8s %8s\n", "", "appels", "moy [ns]", "p99 [ns]", "max [ns]", "aucune", "erreurs");
+  for (int kind = 0; kind < KINDS; ++kind) {
+    auto& t = times[kind];
+    std::sort(t.begin(), t.end());
+    double sum = 0;
+    for (const double v : t) sum += v;
+    std::printf("%-16s %10zu %10.0f %10.0f %10.0f %8u %8u\n", kinds[kind], t.size(), sum / t.size(),
+      t[size_t(0.99 * (t.size() - 1))], t.back(), never[kind], wrong[kind]);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Débit du parcours des champs d'extension (ExtensionIterator) sur un corpus de datagrammes : entête seul,
+// entête et MAC, requêtes et réponses NTS, champs multiples aléatoires et datagrammes mal formés.
+// Usage : bench_extension [tours]
+
+#include "extension.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+struct Datagram {
+  uint8_t data[NTP_MAX_PACKET];
+  size_t  len;
+};
+
+struct Family {
+  const char*           name;
+  std::vector<Datagram> packets;
+};
+
+static Datagram build(const unsigned fields, const size_t valueLength, const size_t mac) {
+  Datagram d;
+  uint8_t value[NTP_MAX_PACKET] = {};
+  ExtensionBuilder builder(d.data, sizeof(d.data));
+  builder.header(NTP::makeNTP(NTPMODE_CLIENT));
+  for (unsigned i = 0; i < fields; ++i) builder.add(0x0104 + (i << 8), value, valueLength);
+  d.len = mac ? builder.size() : builder.finish();
+  for (size_t i = 0; i < mac; ++i) d.data[d.len++] = 0xA5;
+  return d;
+}
+
+int main(int argc, char* argv[]) {
+  const int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const size_t corpus = 1024;
+  srand(1);
+
+  std::vector<Family> families = { { "header", {} }, { "header+MAC", {} }, { "NTS request", {} }, { "NTS reply", {} },
+                                   { "random fields", {} }, { "malformed", {} } };
+  for (size_t i = 0; i < corpus; ++i) {
+    families[0].packets.push_back(build(0, 0, 0));
+    families[1].packets.push_back(build(0, 0, 24));
+    families[2].packets.push_back(build(3 + rand() % 7, 100, 0));    // UID, cookie, emplacements, authentificateur.
+    families[3].packets.push_back(build(2, 136, 0));                 // UID, authentificateur et cookies chiffrés.
+    families[4].packets.push_back(build(1 + rand() % 12, rand() % 64, rand() % 2 ? 20 : 0));
+    Datagram bad = build(1 + rand() % 4, 16 + rand() % 32, 0);
+    const size_t at = NTP::packetSize() + 2;
+    const uint16_t length = rand() % 3 ? 0xFFFC : 6;                 // au-delà du datagramme, ou trop court.
+    bad.data[at] = length >> 8;
+    bad.data[at + 1] = length & 0xFF;
+    families[5].packets.push_back(bad);
+  }
+
+  unsigned long checksum = 0;
+  for (auto& family : families) {
+    size_t bytes = 0, fields = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+      for (const auto& d : family.packets) {
+        ExtensionIterator it(d.data, d.len);
+        for (ExtensionField field; it.next(field); ) {
+          checksum += field.type + field.value[0];
+          ++fields;
+        }
+        checksum += it.offset();
+        bytes += d.len;
+      }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    const double packets = double(rounds) * family.packets.size();
+    std::printf("%-14s %6.1f ns/packet  %6.1f Mpackets/s  %5.2f GB/s  %4.1f fields/packet\n", family.name,
+      ns / packets, packets * 1e3 / ns, bytes / ns, fields / packets);
+  }
+  std::printf("(checksum %lu)\n", checksum);
+  return 0;
+}
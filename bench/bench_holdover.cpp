@@ -0,0 +1,89 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Holdover de Discipline : un oscillateur simulé (écart fixe, marche aléatoire de fréquence et bruit de mesure)
+// est discipliné pendant SYNC heures, puis l'amont est coupé. L'écart de l'horloge locale est affiché au fil du
+// holdover, une fois avec la fréquence apprise appliquée par tick(), une fois avec la fréquence remise à zéro.
+// Usage : bench_holdover [ppm] [heures de holdover]
+
+#include "discipline.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define SYNC    (6 * 3600UL)  // durée de la discipline avant la coupure [s].
+#define START   1000000UL     // heure UTC simulée du démarrage [s].
+#define NOISE   200.0         // bruit de mesure de l'offset (écart-type) [µs].
+#define WANDER  0.002         // marche aléatoire de la fréquence (écart-type par seconde) [ppm].
+#define REPORT  900UL         // intervalle d'affichage pendant le holdover [s].
+
+/**
+ * Simule la discipline puis le holdover ; l'écart de l'horloge locale (locale - vraie) est relevé toutes les
+ * REPORT secondes après la coupure.
+ * @param ppm Ecart de fréquence de l'oscillateur, positif s'il retarde.
+ * @param holdover Durée du holdover [s].
+ * @param learned Faux pour remettre la fréquence à zéro à la coupure.
+ * @param errors Ecarts relevés [µs].
+ * @return La fréquence apprise à la coupure [ppm].
+ */
+static double simulate(const double ppm, const unsigned long holdover, const bool learned, std::vector<double>& errors) {
+  std::mt19937 rng(1);    // même oscillateur et même bruit pour les deux passes.
+  std::normal_distribution<double> noise(0, NOISE), wander(0, WANDER);
+  Discipline discipline;
+  double freq = ppm;
+  double error = 0;       // horloge locale - heure vraie [µs].
+  unsigned long next = START;
+  double atCut = 0;
+
+  for (unsigned long epoch = START; epoch < START + SYNC + holdover; ++epoch) {
+    freq += wander(rng);
+    error -= freq;
+    error += discipline.tick(epoch);
+
+    if (epoch < START + SYNC) {
+      if (epoch >= next) {
+        error += discipline.update(int64_t(-error + noise(rng)), epoch);
+        next = epoch + discipline.getPoll();
+      }
+      continue;
+    }
+    if (epoch == START + SYNC) {
+      atCut = discipline.getFrequency();
+      if (!learned) discipline.restore(0);
+    }
+    if ((epoch - START - SYNC) % REPORT == 0) errors.push_back(error);
+  }
+  return atCut;
+}
+
+int main(int argc, char* argv[]) {
+  const double ppm = argc > 1 ? std::atof(argv[1]) : 12.0;
+  const unsigned long holdover = (argc > 2 ? std::atol(argv[2]) : 6) * 3600UL;
+
+  std::vector<double> learned, zeroed;
+  const double freq = simulate(ppm, holdover, true, learned);
+  simulate(ppm, holdover, false, zeroed);
+
+  std::printf("oscillateur %+.2f ppm, fréquence apprise à la coupure %+.3f ppm\n", ppm, freq);
+  std::printf("%8s %16s %16s\n", "holdover", "apprise [ms]", "nulle [ms]");
+  for (size_t i = 0; i < learned.size(); ++i) {
+    std::printf("%6lu s %16.3f %16.3f\n", i * REPORT, learned[i] / 1000, zeroed[i] / 1000);
+  }
+  return 0;
+}
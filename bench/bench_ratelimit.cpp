@@ -0,0 +1,67 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Coût de RateLimiter::check() sur le chemin des requêtes : un client unique, une population qui tient dans
+// la table, puis une population bien plus grande (évictions à chaque requête), comparé au coût d'une réponse.
+// Usage : bench_ratelimit [requêtes]
+
+#include "ratelimit.h"
+#include "responder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static double measure(const std::vector<uint32_t>& ips, const int requests, unsigned verdicts[3]) {
+  RateLimiter limiter;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < requests; ++i) {
+    ++verdicts[limiter.check(ips[i % ips.size()], i / 1000)];   // 1000 requêtes par milliseconde.
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / requests;
+}
+
+int main(int argc, char* argv[]) {
+  const int requests = argc > 1 ? std::atoi(argv[1]) : 20000000;
+  srand(1);
+
+  const size_t populations[] = { 1, RATE_SLOTS / 2, 100000 };
+  for (const size_t population : populations) {
+    std::vector<uint32_t> ips(population);
+    for (auto& ip : ips) ip = uint32_t(rand()) ^ (uint32_t(rand()) << 16);
+    unsigned verdicts[3] = {};
+    const double ns = measure(ips, requests, verdicts);
+    std::printf("%6zu clients: %5.1f ns per check (%.0f M/s)  pass %u  kod %u  drop %u\n", population, ns, 1000 / ns,
+      verdicts[RATE_PASS], verdicts[RATE_KOD], verdicts[RATE_DROP]);
+  }
+
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, 1);
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  request.setT3(2);
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < requests; ++i) {
+    request.setT3(request.getT3() + 1);
+    responder.respond(request, reply);
+  }
+  const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / requests;
+  std::printf("for comparison, respond(): %.1f ns per reply (check %llu)\n", ns, (unsigned long long)reply.getT1());
+  return 0;
+}
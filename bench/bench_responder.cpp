@@ -0,0 +1,80 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Répondeur en mode serveur sur la boucle locale : coût de respond() seul, puis requêtes par seconde et
+// aller-retour p99 d'un serveur mono-thread (LinuxTransport) sous la charge de bench/loadgen.h.
+// Usage : bench_responder [clients] [secondes]
+
+#include "linux_transport.h"
+#include "responder.h"
+#include "loadgen.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define SERVER_PORT 12343
+
+static std::atomic<bool> serving(true);
+
+static void serve(LinuxTransport& transport, const Responder& responder) {
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  Endpoint from;
+  while (serving) {
+    if (!transport.receive(request, from, 20)) continue;
+    if (responder.respond(request, reply)) transport.send(reply, from);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned clients = argc > 1 ? std::atoi(argv[1]) : 4;
+  const double seconds = argc > 2 ? std::atof(argv[2]) : 2;
+
+  LinuxTransport server;
+  if (!server.begin(SERVER_PORT)) {
+    std::printf("port %d indisponible\n", SERVER_PORT);
+    return 1;
+  }
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, server.now());
+
+  {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    request.setT0(server.now());
+    request.setT3(server.now());
+    const int rounds = 10000000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+      request.setT3(request.getT3() + 1);
+      responder.respond(request, reply);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::printf("respond(): %.1f ns per reply (check %llu)\n", ns / rounds, (unsigned long long)reply.getT1());
+  }
+
+  std::thread thread(serve, std::ref(server), std::cref(responder));
+  const auto result = generateLoad(SERVER_PORT, clients, 8, seconds);
+  serving = false;
+  thread.join();
+
+  std::printf("%u clients x 8 in flight, %.1f s: %.0f req/s, turnaround p50 %.0f us, p99 %.0f us (%llu sent, %llu answered)\n",
+    clients, result.seconds, result.rate(), result.p50, result.p99, (unsigned long long)result.sent,
+    (unsigned long long)result.received);
+  return 0;
+}
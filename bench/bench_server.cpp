@@ -0,0 +1,55 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Requêtes par seconde de LinuxServer selon le nombre de threads, sous la charge de bench/loadgen.h (deux
+// clients par thread serveur). Sur la boucle locale, les clients partagent les cœurs avec le serveur : la
+// montée en charge mesurée est un minorant de celle obtenue avec des clients distants.
+// Usage : bench_server [threads max] [secondes par palier]
+
+#include "linux_server.h"
+#include "loadgen.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#define SERVER_PORT 12363
+
+int main(int argc, char* argv[]) {
+  const unsigned maxThreads = argc > 1 ? std::atoi(argv[1]) : std::max(1U, std::thread::hardware_concurrency());
+  const double seconds = argc > 2 ? std::atof(argv[2]) : 2;
+
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, (uint64_t(time(nullptr)) + YEAR1970) * 1000000ULL);
+
+  std::printf("threads      req/s   p50 [us]   p99 [us]\n");
+  double single = 0;
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    LinuxServer server(responder, threads, false);
+    if (!server.start(SERVER_PORT)) {
+      std::printf("port %d indisponible\n", SERVER_PORT);
+      return 1;
+    }
+    const auto result = generateLoad(SERVER_PORT, 2 * threads, 16, seconds);
+    server.stop();
+    if (threads == 1) single = result.rate();
+    std::printf("%7u %10.0f %10.0f %10.0f   x%.2f\n", threads, result.rate(), result.p50, result.p99,
+      single ? result.rate() / single : 0);
+  }
+  return 0;
+}
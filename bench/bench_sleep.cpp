@@ -0,0 +1,116 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Erreur de SleepClock en fonctionnement cyclique (DUTY_CYCLE) : le compteur RTC est un oscillateur RC simulé
+// dont la période dérive avec la température (cycle de 24 h), réveillé toutes les DUTY_DISPLAY secondes pour
+// l'affichage et toutes les DUTY_POLL secondes pour un polling, comme Application::wakeUp() et goToSleep().
+// Pour chaque DUTY_POLL sont affichés l'erreur au réveil du polling, l'erreur maximale des réveils d'affichage
+// qui l'ont précédé, la borne getMaxError() et la correction apprise.
+// Usage : bench_sleep [heures] [amplitude de la dérive en ppm]
+
+#include "sleep.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#define DUTY_POLL    900          // comme application.h [s]
+#define DUTY_DISPLAY 60           // comme application.h [s]
+#define NOMINAL      (1e6 / 150000)   // période nominale du RC [µs]
+#define BIAS         300.0        // écart de la période réelle au démarrage [ppm]
+#define CAL_ERROR    -2000.0      // erreur de rtc_clk_cal() au démarrage à froid [ppm]
+#define AWAKE        0.2          // durée d'un réveil d'affichage [s]
+#define POLLING      1.5          // durée d'un réveil avec polling [s]
+#define START        1790000000UL // heure UTC simulée du démarrage [s]
+#define EPOCH1900    2208988800ULL
+
+static double amplitude;
+static double now;      // heure vraie depuis START [s]
+static double ticks;    // compteur RTC
+
+// Période du RC à l'instant t : dérive thermique sur 24 h [µs].
+static double period(const double t) {
+  return NOMINAL * (1 + (BIAS + amplitude * sin(2 * M_PI * t / 86400)) * 1e-6);
+}
+
+// Fait avancer l'heure vraie et le compteur RTC.
+static void run(double seconds) {
+  while (seconds > 0) {
+    const double step = seconds < 1 ? seconds : 1;
+    ticks += step * 1e6 / period(now + step / 2);
+    now += step;
+    seconds -= step;
+  }
+}
+
+static uint64_t trueMicros() {
+  return uint64_t((START + EPOCH1900) * 1e6 + now * 1e6);
+}
+
+int main(int argc, char* argv[]) {
+  const double hours = argc > 1 ? std::atof(argv[1]) : 24;
+  amplitude = argc > 2 ? std::atof(argv[2]) : 500;
+
+  SleepState retained = {};
+// Démarrage à froid : période nominale mal connue, puis mesurée contre le timer principal pendant loop().
+  {
+    SleepClock clock(retained);
+    clock.reset(NOMINAL * (1 + CAL_ERROR * 1e-6), START, 1000, DUTY_POLL);
+    for (int i = 0; i < 30; ++i) {   // 30 s d'éveil jusqu'à la première synchronisation.
+      clock.calibrate(uint64_t(ticks), int64_t(now * 1e6));
+      run(1);
+    }
+  }
+
+  std::printf("RC %.0f ppm +/- %.0f ppm sur 24 h, polling %u s, affichage %u s\n", BIAS, amplitude, DUTY_POLL, DUTY_DISPLAY);
+  std::printf("%8s %14s %14s %14s %12s\n", "heure", "polling [us]", "max [us]", "borne [us]", "corr [ppm]");
+
+  int64_t local = 0;      // erreur de l'heure locale (locale - vraie) [µs]
+  int64_t worst = 0;      // erreur maximale des réveils d'affichage depuis le dernier polling [µs]
+  double awake = 0;
+  while (now < hours * 3600) {
+// goToSleep() : sommeil jusqu'au prochain affichage ou polling.
+    SleepClock clock(retained);
+    const uint64_t time = trueMicros() + local;
+    clock.sleep(time, uint64_t(ticks));
+    const unsigned long epoch = time / 1000000 - EPOCH1900;
+    unsigned long next = (epoch / DUTY_DISPLAY + 1) * DUTY_DISPLAY;
+    if (next > clock.getNextPoll()) next = clock.getNextPoll();
+    if (next <= epoch) next = epoch + 1;
+    run(double((next - epoch) * 1000000 - time % 1000000) * 1e-6);
+
+// wakeUp() : estimation de l'heure par le compteur RTC.
+    SleepClock woken(retained);
+    const uint64_t estimate = woken.wake(uint64_t(ticks));
+    local = int64_t(estimate - trueMicros());
+    const unsigned long wake = estimate / 1000000 - EPOCH1900;
+    if (wake < woken.getNextPoll()) {
+      if (llabs(local) > llabs(worst)) worst = local;
+      awake = AWAKE;
+    } else {
+      woken.setNextPoll(wake + DUTY_POLL);
+      const unsigned long utc = START + (unsigned long)now;
+      std::printf("%6.2f h %14lld %14lld %14u %12.1f\n", now / 3600, (long long)local, (long long)worst,
+        woken.getMaxError(utc), woken.getPpm());
+      woken.learn(-local, utc, 1000);
+      local = 0;    // l'estimation est remplacée par l'heure NTP.
+      worst = 0;
+      awake = POLLING;
+    }
+    run(awake);
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Gigue de l'offset mesuré sur la boucle locale : T3 estampillé par le noyau (LinuxTransport) contre T3 pris en
+// espace utilisateur au retour de la réception. Les deux extrémités partagent l'horloge : l'offset vrai est nul.
+// Usage : bench_transport [échanges]
+
+#include "linux_transport.h"
+#include "responder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#define SERVER_PORT 12333
+#define CLIENT_PORT 12334
+
+static std::atomic<bool> running(true);
+
+static void serve(LinuxTransport& transport, const Responder& responder) {
+  while (running) {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    Endpoint from;
+    if (!transport.receive(request, from, 20)) continue;
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    if (responder.respond(request, reply)) transport.send(reply, from);
+  }
+}
+
+static void report(const char name[], std::vector<double>& offsets) {
+  double sum = 0, sum2 = 0;
+  for (const double o : offsets) {
+    sum += o;
+    sum2 += o * o;
+  }
+  const double mean = sum / offsets.size();
+  std::sort(offsets.begin(), offsets.end(), [](const double a, const double b) { return std::fabs(a) < std::fabs(b); });
+  std::printf("%-12s mean %7.2f us  stddev %7.2f us  |offset| p50 %7.2f us  p99 %7.2f us\n", name, mean,
+    std::sqrt(sum2 / offsets.size() - mean * mean), std::fabs(offsets[offsets.size() / 2]),
+    std::fabs(offsets[offsets.size() * 99 / 100]));
+}
+
+int main(int argc, char* argv[]) {
+  const int exchanges = argc > 1 ? std::atoi(argv[1]) : 5000;
+
+  LinuxTransport server;
+  LinuxTransport client;
+  if (!server.begin(SERVER_PORT) || !client.begin(CLIENT_PORT)) {
+    std::printf("ports %d/%d indisponibles\n", SERVER_PORT, CLIENT_PORT);
+    return 1;
+  }
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, server.now());
+  std::thread thread(serve, std::ref(server), std::cref(responder));
+
+  std::vector<double> kernel, user;
+  for (int i = 0; i < exchanges; ++i) {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    if (!client.send(request, "127.0.0.1", SERVER_PORT)) continue;
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    Endpoint from;
+    if (!client.receive(reply, from, 1000)) continue;
+    const uint64_t late = client.now();     // estampille prise après le retour en espace utilisateur.
+    kernel.push_back(reply.getOffset());
+    reply.setT3(late);
+    user.push_back(reply.getOffset());
+  }
+  running = false;
+  thread.join();
+
+  if (kernel.empty()) return 1;
+  std::printf("%zu exchanges on loopback (kernel stamps: %s)\n", kernel.size(), client.kernelStamps() ? "yes" : "no");
+  report("kernel T3", kernel);
+  report("user T3", user);
+  return 0;
+}
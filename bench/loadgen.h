@@ -0,0 +1,115 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+// Générateur de charge NTP pour les bancs de mesure : des clients sur la boucle locale, chacun avec sa socket et
+// une fenêtre de requêtes en vol. Le temps d'aller-retour de chaque réponse est mesuré côté client, par l'écho
+// du champ Transmit de la requête dans le champ Origin de la réponse.
+
+#include "ntp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+struct LoadResult {
+  uint64_t sent;
+  uint64_t received;
+  double   seconds;
+  double   p50;        // [µs] aller-retour médian.
+  double   p99;        // [µs]
+  double rate() const { return received / seconds; }
+};
+
+static uint64_t steadyMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void loadClient(const uint16_t port, const unsigned depth, const std::atomic<bool>& running,
+                       std::atomic<uint64_t>& sent, std::vector<uint32_t>& turnaround) {
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if ((fd < 0) || connect(fd, (struct sockaddr*)&addr, sizeof(addr))) return;
+
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  uint8_t buffer[NTP_MAX_PACKET];
+  unsigned inFlight = 0;
+  uint64_t count = 0;
+  while (running) {
+    for (; inFlight < depth; ++inFlight, ++count) {
+      request.setT0(steadyMicros() + YEAR1970 * 1000000ULL);  // horloge monotone : seul l'écho compte.
+      if (::send(fd, request.packetAddr(), request.length(), 0) < 0) break;
+    }
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 20) <= 0) {
+      inFlight = 0;   // réponses perdues : on relance une fenêtre complète.
+      continue;
+    }
+    while (recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT) >= NTP::packetSize()) {
+      reply.setPacket(buffer);
+      turnaround.push_back(steadyMicros() + YEAR1970 * 1000000ULL - reply.getT0());
+      if (inFlight) --inFlight;
+    }
+  }
+  sent += count;
+  close(fd);
+}
+
+/**
+ * Charge un serveur NTP local pendant une durée fixe.
+ * @param port Port du serveur sur 127.0.0.1.
+ * @param clients Nombre de clients (un thread et une socket chacun).
+ * @param depth Requêtes en vol par client.
+ * @param seconds Durée de la mesure.
+ */
+static LoadResult generateLoad(const uint16_t port, const unsigned clients, const unsigned depth, const double seconds) {
+  std::atomic<bool> running(true);
+  std::atomic<uint64_t> sent(0);
+  std::vector<std::vector<uint32_t>> turnarounds(clients);
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < clients; ++i) {
+    turnarounds[i].reserve(1 << 20);
+    threads.emplace_back(loadClient, port, depth, std::cref(running), std::ref(sent), std::ref(turnarounds[i]));
+  }
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  running = false;
+  for (auto& t : threads) t.join();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<uint32_t> all;
+  for (const auto& t : turnarounds) all.insert(all.end(), t.begin(), t.end());
+  LoadResult result = { sent, all.size(), elapsed, 0, 0 };
+  if (!all.empty()) {
+    std::nth_element(all.begin(), all.begin() + all.size() / 2, all.end());
+    result.p50 = all[all.size() / 2];
+    std::nth_element(all.begin(), all.begin() + all.size() * 99 / 100, all.end());
+    result.p99 = all[all.size() * 99 / 100];
+  }
+  return result;
+}
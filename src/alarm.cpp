@@ -0,0 +1,172 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+
+#include "alarm.h"
+
+#include <Arduino.h>
+
+AlarmHeap::AlarmHeap(Alarm* aSlots[], const size_t aCapacity) :
+  slots(aSlots),
+  capacity(aCapacity),
+  count(0)
+{}
+
+bool AlarmHeap::push(Alarm& alarm) {
+  if (count >= capacity) return false;
+  set(count, &alarm);
+  up(count++);
+  return true;
+}
+
+void AlarmHeap::remove(Alarm& alarm) {
+  const size_t i = alarm.index;
+  if ((i >= count) || (slots[i] != &alarm)) return;
+  alarm.index = SIZE_MAX;
+  if (i == --count) return;
+  set(i, slots[count]);   // le dernier prend la place, puis remonte ou descend.
+  up(i);
+  down(slots[i]->index);
+}
+
+Alarm* AlarmHeap::pop() {
+  if (!count) return nullptr;
+  Alarm* const first = slots[0];
+  remove(*first);
+  return first;
+}
+
+void AlarmHeap::up(size_t i) {
+  Alarm* const alarm = slots[i];
+  while (i > 0) {
+    const size_t parent = (i - 1) / 2;
+    if (slots[parent]->when <= alarm->when) break;
+    set(i, slots[parent]);
+    i = parent;
+  }
+  set(i, alarm);
+}
+
+void AlarmHeap::down(size_t i) {
+  Alarm* const alarm = slots[i];
+  while (true) {
+    size_t child = 2 * i + 1;
+    if (child >= count) break;
+    if ((child + 1 < count) && (slots[child + 1]->when < slots[child]->when)) ++child;
+    if (alarm->when <= slots[child]->when) break;
+    set(i, slots[child]);
+    i = child;
+  }
+  set(i, alarm);
+}
+
+AlarmScheduler::AlarmScheduler(ESP32Time& aTime, Alarm* aSlots[], const size_t aCapacity) :
+  time(aTime),
+  heap(aSlots, aCapacity),
+  lock(portMUX_INITIALIZER_UNLOCKED),
+  timer(nullptr)
+{}
+
+bool AlarmScheduler::begin() {
+  esp_timer_create_args_t args = {};
+  args.callback = fire;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "alarm";
+  if (esp_timer_create(&args, &timer) != ESP_OK) return false;
+  rearm();
+  return true;
+}
+
+uint64_t AlarmScheduler::now() const {
+  auto epoch = time.getEpoch();
+  auto micros = time.getMicros();
+  const auto check = time.getEpoch();
+  if (check != epoch) {   // la seconde a changé entre les deux lectures.
+    epoch = check;
+    micros = time.getMicros();
+  }
+  return uint64_t(epoch) * 1000000 + micros;
+}
+
+bool AlarmScheduler::schedule(Alarm& alarm, const uint64_t when, const uint32_t period) {
+  if (alarm.pin != ALARM_NO_PIN) pinMode(alarm.pin, OUTPUT);
+
+  portENTER_CRITICAL(&lock);
+  heap.remove(alarm);
+  alarm.when = when;
+  alarm.period = period;
+  const bool ok = heap.push(alarm);
+  const bool first = heap.top() == &alarm;
+  portEXIT_CRITICAL(&lock);
+
+  if (first && timer) arm(now());   // sinon le timer est déjà armé plus tôt.
+  return ok;
+}
+
+void AlarmScheduler::cancel(Alarm& alarm) {
+  portENTER_CRITICAL(&lock);
+  heap.remove(alarm);
+  portEXIT_CRITICAL(&lock);
+}
+
+void AlarmScheduler::rearm() {
+  if (timer) arm(now());
+}
+
+unsigned AlarmScheduler::run(const uint64_t current) {
+  unsigned fired = 0;
+  while (true) {
+    portENTER_CRITICAL(&lock);
+    Alarm* const alarm = heap.top();
+    if (!alarm || (alarm->when > current + ALARM_EARLY)) {
+      portEXIT_CRITICAL(&lock);
+      break;
+    }
+    heap.pop();
+    if (alarm->period) {
+      const uint64_t period = uint64_t(alarm->period) * 1000000;
+      // Prochaine échéance après current ; une alarme déclenchée en avance (ALARM_EARLY) avance d'une période.
+      alarm->when += current > alarm->when ? (1 + (current - alarm->when) / period) * period : period;
+      heap.push(*alarm);
+    }
+    portEXIT_CRITICAL(&lock);
+
+    if (alarm->pin != ALARM_NO_PIN) digitalWrite(alarm->pin, alarm->level);
+    if (alarm->callback) alarm->callback(*alarm);
+    ++fired;
+  }
+  return fired;
+}
+
+void AlarmScheduler::fire(void* self) {
+  AlarmScheduler& scheduler = *(AlarmScheduler*)self;
+  scheduler.run(scheduler.now());
+  scheduler.arm(scheduler.now());
+}
+
+void AlarmScheduler::arm(const uint64_t current) {
+  portENTER_CRITICAL(&lock);
+  const Alarm* const next = heap.top();
+  const uint64_t when = next ? next->when : 0;
+  portEXIT_CRITICAL(&lock);
+
+  esp_timer_stop(timer);
+  if (!next) return;
+  const uint64_t delay = when > current ? when - current : 1;
+  esp_timer_start_once(timer, delay < ALARM_AHEAD ? delay : ALARM_AHEAD);
+}
@@ -0,0 +1,184 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ESP32Time.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+#define ALARM_NO_PIN  0xFF      // Alarme sans action sur une sortie.
+#define ALARM_AHEAD   1000000   // Le timer n'est jamais armé plus loin : il suit ainsi les corrections d'horloge [µs].
+#define ALARM_EARLY   200       // Une alarme échue à moins de ALARM_EARLY µs près est déclenchée [µs].
+
+/**
+ * Alarme planifiée dans un AlarmScheduler. L'alarme appartient à l'appelant (aucune allocation) et doit rester
+ * en place tant qu'elle est planifiée.
+ */
+struct Alarm {
+  Alarm(void (*aCallback)(Alarm&) = nullptr, void* aContext = nullptr, const uint8_t aPin = ALARM_NO_PIN, const uint8_t aLevel = 1) :
+    when(0), period(0), callback(aCallback), context(aContext), pin(aPin), level(aLevel), index(SIZE_MAX) {}
+
+/**
+ * Indique que l'alarme est planifiée.
+ */
+  bool isPending() const { return index != SIZE_MAX; }
+
+  uint64_t when;                  // Echéance, temps UTC discipliné [µs depuis 1970] ; déjà la suivante dans le rappel d'une alarme périodique.
+  uint32_t period;                // Période de répétition [s], 0 pour une alarme unique.
+  void (*callback)(Alarm&);       // Appelé à l'échéance (tâche esp_timer) ; peut replanifier l'alarme.
+  void* context;                  // Libre pour l'appelant.
+  uint8_t pin;                    // Sortie positionnée à l'échéance, ALARM_NO_PIN sinon.
+  uint8_t level;                  // Niveau de la sortie.
+
+  size_t index;                   // Position dans le tas (réservé à AlarmHeap).
+};
+
+/**
+ * Tas binaire (min-heap) d'alarmes rangées par échéance, dans un tableau fourni par l'appelant. Insertion,
+ * retrait du minimum et annulation en O(log n) : chaque alarme connaît sa position dans le tas.
+ */
+class AlarmHeap {
+  public:
+/**
+ * Public constructor.
+ * @param aSlots Tableau de capacité aCapacity.
+ * @param aCapacity Nombre maximum d'alarmes planifiées.
+ */
+    AlarmHeap(Alarm* aSlots[], const size_t aCapacity);
+
+/**
+ * Ajoute une alarme (qui ne doit pas être planifiée).
+ * @return Faux si le tas est plein.
+ */
+    bool push(Alarm& alarm);
+
+/**
+ * Retire une alarme planifiée (sans effet sinon).
+ */
+    void remove(Alarm& alarm);
+
+/**
+ * Retourne l'alarme de plus proche échéance, nullptr si le tas est vide.
+ */
+    Alarm* top() const { return count ? slots[0] : nullptr; }
+
+/**
+ * Retire et retourne l'alarme de plus proche échéance, nullptr si le tas est vide.
+ */
+    Alarm* pop();
+
+    size_t size() const { return count; }
+
+  private:
+/**
+ * Range l'alarme en position i à sa place, en la remontant ou en la descendant.
+ */
+    void up(size_t i);
+    void down(size_t i);
+
+/**
+ * Place une alarme en position i.
+ */
+    void set(const size_t i, Alarm* const alarm) {
+      slots[i] = alarm;
+      alarm->index = i;
+    }
+
+    Alarm**      slots;
+    const size_t capacity;
+    size_t       count;
+};
+
+/**
+ * Alarmes à l'heure UTC disciplinée, déclenchées par un esp_timer. Le timer est armé sur l'échéance la plus
+ * proche, mais jamais à plus de ALARM_AHEAD : l'horloge pouvant être corrigée (slew, saut, seconde
+ * intercalaire) entre-temps, l'échéance est recalculée sur l'horloge à chaque déclenchement et rearm() doit être
+ * appelé après une correction. Un déclenchement en avance est simplement réarmé.
+ *
+ * Les rappels s'exécutent dans la tâche esp_timer : ils doivent être brefs.
+ */
+class AlarmScheduler {
+  public:
+/**
+ * Public constructor.
+ * @param aTime Horloge disciplinée (UTC).
+ * @param aSlots Tableau de capacité aCapacity pour le tas.
+ * @param aCapacity Nombre maximum d'alarmes planifiées.
+ */
+    AlarmScheduler(ESP32Time& aTime, Alarm* aSlots[], const size_t aCapacity);
+
+/**
+ * Crée le timer et l'arme pour les alarmes déjà planifiées.
+ * @return Faux si le timer n'a pas pu être créé.
+ */
+    bool begin();
+
+/**
+ * Planifie (ou replanifie) une alarme.
+ * @param alarm Alarme ; annulée d'abord si elle était planifiée.
+ * @param when Echéance UTC [µs depuis 1970].
+ * @param period Période de répétition [s], 0 pour une alarme unique.
+ * @return Faux si le tas est plein.
+ */
+    bool schedule(Alarm& alarm, const uint64_t when, const uint32_t period = 0);
+
+/**
+ * Annule une alarme (sans effet si elle n'est pas planifiée).
+ */
+    void cancel(Alarm& alarm);
+
+/**
+ * Réarme le timer sur l'horloge ; à appeler après chaque correction de l'horloge.
+ */
+    void rearm();
+
+/**
+ * Retourne l'heure UTC de l'horloge disciplinée [µs depuis 1970].
+ */
+    uint64_t now() const;
+
+/**
+ * Déclenche les alarmes échues : sortie, rappel, puis replanification des alarmes périodiques après
+ * l'heure courante (les périodes manquées sont sautées).
+ * @param current Heure UTC [µs depuis 1970].
+ * @return Nombre d'alarmes déclenchées.
+ */
+    unsigned run(const uint64_t current);
+
+    size_t size() const { return heap.size(); }
+
+  private:
+/**
+ * Rappel du timer.
+ */
+    static void fire(void* self);
+
+/**
+ * Arme le timer sur l'échéance la plus proche, ou ALARM_AHEAD au plus ; l'arrête s'il n'y a plus d'alarme.
+ * @param current Heure UTC [µs depuis 1970].
+ */
+    void arm(const uint64_t current);
+
+    ESP32Time&          time;
+    AlarmHeap           heap;
+    portMUX_TYPE        lock;     // Tâche esp_timer contre loop().
+    esp_timer_handle_t  timer;
+};
@@ -18,7 +18,11 @@
 #include "application.h"
 
 #include <esp_wifi.h>
-#include <vector>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <soc/rtc.h>
+#include <esp_random.h>
+#include <cmath>
 // #include "ftntp_client.h"
 #include "splash.h"
 
@@ -26,30 +30,38 @@ TimeChangeRule frSTD = {"CET", Last, Sun, Mar, 2, +120};   // UTC +2 hours
 TimeChangeRule frDST = {"CEST", Last, Sun, Oct, 3, +60};  // UTC +1 hours
 Timezone frParis(frSTD, frDST);
 
-Application::Application() : tft(TFT_eSPI()), time(0), udp(), timezone(frParis), servers()
+RTC_DATA_ATTR static SleepState retained;  // survives deep sleep (duty cycle).
+
+Application::Application() : tft(TFT_eSPI()), time(0), transport(time), server(time), upstream(), responder(), limiter(), broadcastClient(), control(), keys(), nts(), peers(), interleave(), interleaveServer(), lastSync(0), lastMeasure(0), lastRetry(0), splashEnd(0), sensor(), thermal(), thermalSum(0), thermalCount(0), driftStore("ntp", "drift"), drift(driftStore, DRIFT_INTERVAL), sleepClock(retained), wifiStore("ntp", "wifi"), wifiCache(wifiStore), frames(), display(nullptr), stampStats(), lastServe(0), ticker(time, onTick, this), boundaryStats(), wheel(), displayTimer(onDisplay, this), pollTimer(onPoll, this), peerTimers(), broadcastTimer(onSendBroadcast, this), calibrateTimer(onCalibrate, this), thermalTimer(onThermal, this), flushTimer(onFlush, this), reportTimer(onReport, this), alarmSlots(), alarms(time, alarmSlots, ALARM_CAPACITY), leap(LEAP_SMEAR, LEAP_TABLE), leapExpired(false), timezone(frParis), servers(), discipline()
 {
+  for (auto& timer : peerTimers) timer = TimerEntry(onPeerPoll, this);
   tft.init();
   tft.setRotation(3);
 }
 
 bool Application::initWiFi() {
-
-  tft.setCursor(0,0);
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextColor(TFT_YELLOW, TFT_BLACK);
-  tft.setTextFont(4);
-  tft.println("Setup WiFi");
-  tft.setTextFont(2);
-  const auto xPos = tft.getCursorX();
-  const auto yPos = tft.getCursorY();
-
-  esp_netif_create_default_wifi_sta();
+  const int64_t t0 = esp_timer_get_time();
+
+  const bool splash = splashEnd;   // the association runs under the splash screen.
+  const auto header = [this]() {
+    tft.setCursor(0,0);
+    tft.fillScreen(TFT_BLACK);
+    tft.setTextColor(TFT_YELLOW, TFT_BLACK);
+    tft.setTextFont(4);
+    tft.println("Setup WiFi");
+    tft.setTextFont(2);
+  };
+  if (!splash) header();
+  auto xPos = tft.getCursorX();
+  auto yPos = tft.getCursorY();
+
+  esp_netif_t* const netif = esp_netif_create_default_wifi_sta();
 
   wifi_init_config_t wifi_init = WIFI_INIT_CONFIG_DEFAULT();
   ESP_ERROR_CHECK(esp_wifi_init(&wifi_init));
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
 
-  wifi_config_t wifi_config;
+  wifi_config_t wifi_config = {};
   strncpy((char*)wifi_config.sta.ssid, WIFI_SSID, sizeof(wifi_config.sta.ssid));
   strncpy((char*)wifi_config.sta.password, WIFI_PASS, sizeof(wifi_config.sta.password));
   wifi_config.sta.bssid_set = false;
@@ -57,23 +69,86 @@ bool Application::initWiFi() {
   wifi_config.sta.pmf_cfg.capable = true;
   wifi_config.sta.pmf_cfg.required = false;
 
+  WiFiLease lease;
+  const bool cached = WIFI_FAST_CONNECT && wifiCache.load(lease);
+  if (cached) {   // directed connect: no channel scan.
+    wifi_config.sta.bssid_set = true;
+    memcpy(wifi_config.sta.bssid, lease.bssid, sizeof(lease.bssid));
+    wifi_config.sta.channel = lease.channel;
+    wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    if (WIFI_STATIC_IP && lease.ip) {   // no DHCP exchange.
+      esp_netif_dhcpc_stop(netif);
+      esp_netif_ip_info_t info = {};
+      info.ip.addr = lease.ip;
+      info.gw.addr = lease.gateway;
+      info.netmask.addr = lease.netmask;
+      esp_netif_set_ip_info(netif, &info);
+      esp_netif_dns_info_t dns = {};
+      dns.ip.u_addr.ip4.addr = lease.dns;
+      dns.ip.type = ESP_IPADDR_TYPE_V4;
+      esp_netif_set_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+    }
+  }
+
   ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
   ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
   ESP_ERROR_CHECK(esp_wifi_start());
+  const int64_t t1 = esp_timer_get_time();
 
+  if (!splash) {
+    tft.setCursor(xPos, yPos);
+    tft.println("Connecting...");
+  }
   ESP_ERROR_CHECK(esp_wifi_connect());
 
   wifi_ap_record_t ap_info;
-  const auto start = time.getEpoch();
-  while (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
-    yield();
+  int64_t associated = 0;
+  int64_t begin = t1;
+  bool connected = waitWiFi(netif, ap_info, cached ? WIFI_FAST_TIMEOUT : WIFI_TIMEOUT * 1000, associated);
+  if (!connected && cached) {   // the access point or the lease changed: full scan and DHCP.
+    Serial.printf("WiFi fast connect failed after %lld ms\n", (esp_timer_get_time() - t1) / 1000);
+    esp_wifi_disconnect();
+    wifi_config.sta.bssid_set = false;
+    wifi_config.sta.channel = 0;
+    wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (WIFI_STATIC_IP) esp_netif_dhcpc_start(netif);
+    begin = esp_timer_get_time();
+    esp_wifi_connect();
+    connected = waitWiFi(netif, ap_info, WIFI_TIMEOUT * 1000, associated);
+  }
+  const int64_t t2 = esp_timer_get_time();
+  Serial.printf("WiFi %s: init %lld ms, assoc %lld ms, IP %lld ms, total %lld ms\n", cached && (begin == t1) ? "fast" : "scan",
+    (t1 - t0) / 1000, ((associated ? associated : t2) - begin) / 1000, associated ? (t2 - associated) / 1000 : 0, (t2 - t0) / 1000);
+
+  if (splash) {
+    const int64_t left = splashEnd - esp_timer_get_time();
+    if (left > 0) delay(left / 1000);
+    splashEnd = 0;
+    header();
+    xPos = tft.getCursorX();
+    yPos = tft.getCursorY();
+  }
+
+  if (!connected) { // timedout, checkWiFi() will retry from loop().
     tft.setCursor(xPos, yPos);
-    tft.println("Connecting...");
-    if (time.getEpoch() > start + 30) { // timedout
-      ESP_ERROR_CHECK(esp_wifi_sta_get_ap_info(&ap_info));
-    }
+    tft.println("Not connected.");
+    lastRetry = time.getEpoch();
+    return false;
   }
 
+  memcpy(lease.bssid, ap_info.bssid, sizeof(lease.bssid));
+  lease.channel = ap_info.primary;
+  esp_netif_ip_info_t info;
+  esp_netif_get_ip_info(netif, &info);
+  lease.ip = info.ip.addr;
+  lease.gateway = info.gw.addr;
+  lease.netmask = info.netmask.addr;
+  esp_netif_dns_info_t dns;
+  esp_netif_get_dns_info(netif, ESP_NETIF_DNS_MAIN, &dns);
+  lease.dns = dns.ip.u_addr.ip4.addr;
+  if (WIFI_FAST_CONNECT) wifiCache.save(lease);
+
   tft.setCursor(xPos, yPos);
   tft.println("Connected.     ");
   tft.print("SSID: "); tft.println((char*)ap_info.ssid);
@@ -81,66 +156,380 @@ bool Application::initWiFi() {
   return true;
 }
 
+bool Application::waitWiFi(esp_netif_t* const netif, wifi_ap_record_t& ap, const unsigned timeout, int64_t& associated) {
+  const int64_t start = esp_timer_get_time();
+  associated = 0;
+  while (esp_timer_get_time() - start < int64_t(timeout) * 1000) {
+    yield();
+    if (!associated) {
+      if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) associated = esp_timer_get_time();
+      continue;
+    }
+    esp_netif_ip_info_t info;
+    if ((esp_netif_get_ip_info(netif, &info) == ESP_OK) && info.ip.addr) return true;
+  }
+  return false;
+}
+
 void Application::loop() {
   static unsigned long last = 0;  // time.getEpoch()
-  static unsigned poll = 1;
-  static std::vector<int64_t> offsets(10);
+
+  serveNTP();
 
   const auto epoch = time.getEpoch();
   if (epoch != last) {
-    if (!last) tft.fillScreen(TFT_BLACK); // First loop
-    displayTime(epoch);
+    if (!last && !DUAL_CORE) tft.fillScreen(TFT_BLACK); // First loop
 
-    if (!(epoch % poll)) {
-//          Serial.printf("%d + %d >= %d \n", last, poll, epoch);
-      NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
-      sendNTP(ntp, POOL_NTP, PORT_NTP);
+    if (DUTY_CYCLE && lastSync) goToSleep();  // synchronized after a cold boot.
+
+    checkWiFi(epoch);
+    slew(discipline.tick(epoch));  // frequency feed-forward: thermal model, else learned or restored frequency.
+
+    const int step = leap.tick(epoch);  // the local clock follows UTC through the leap second.
+    if (step) {
+      time.setTime(epoch + step, time.getMicros());
+      alarms.rearm();
+      interleave.reset();
+      responder.setLeap(leap.announce());
     }
 
+    const bool steady = last && (epoch > last) && (epoch - last < WHEEL_SLOTS);
+    wheel.advance(steady ? epoch - last : 1);   // catches up on missed seconds, not on clock steps.
+
     last = epoch;
     return;
   }
 
-  NTP ntp = NTP::makeNTP(NTPMODE_CLIENT, 3);
-  if (waitForNTP(ntp, PORT_NTP)) {
-    const auto offset = ntp.getOffset();
-    offsets.insert(offsets.cbegin(), offset);
+  NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+  if (waitForNTP(ntp)) {
+    const auto offset = interleave.getOffset(ntp);   // an interleaved reply is brought up to the local clock as it stands now.
             
-    addServer(ntp.getId(), ntp.getPolling(), epoch);
-    poll = (ntp.getPolling() > 30 ? 30 : ntp.getPolling() );
-    if (!poll) poll = 1;
+    NTPServer* const entry = addServer((const char*)&upstream.ip, ntp.getPolling(), epoch);
+    if (entry) {
+      entry->hpoll = discipline.getPollExponent();
+      const double diff = double(offset - entry->offset);
+      entry->jitter = entry->stratum ? sqrt(entry->jitter * entry->jitter + (diff * diff - entry->jitter * entry->jitter) / 4) : 0;
+      entry->stratum = ntp.getStratum();
+      entry->offset = offset;
+      entry->rtt = ntp.getRTT();
+    }
     const auto rtt = ntp.getRTT();
     const auto ip = ntp.getIP();
     const auto headers = ntp.getHeader();
     const double precision = ntp.getPrecision();
 
-    static const auto P = 0.05;
-    const long correction = ((rtt < 30000) || (precision < 1e-5)) ? (offset * poll) * P : 0;
+    if (!lastSync) {  // WiFi was down at startup: first synchronization.
+      stepTo(ntp);
+      return;
+    }
 
-    if (correction != 0) {
-      const auto d = correction / 1000000;
-      const auto m = correction - d * 1000000;
-      time.setTime(time.getEpoch() + d, time.getMicros() + m);
+    const bool accept = (rtt < 30000) || (precision < 1e-5);
+    const long correction = correct(offset, epoch, accept);
+    if (accept) {
+      discipline.setRoot(ntp.getRootDelay(), ntp.getRootDispersion(), rtt, uint32_t(precision * 1e6) + 1, epoch);
+      responder.update(ntp, (const char*)&upstream.ip, discipline.getPollExponent(), transport.now());
+      responder.setRoot(discipline.getRootDelay(), discipline.getRootDispersion(epoch));
+      updateLeap(ntp.getLeap(), epoch);
+      lastSync = epoch;
     }
+    publishState();
 
     Serial.printf("IP:\"%s\", Hdr:\"%s\", prec:%Lg, ", ip, headers, precision);
-    Serial.printf("Err:%lld, Rtt:%lu, Poll:%d, ",  offset, rtt, poll);
-    Serial.printf("Corr:%ld ", correction);
+    Serial.printf("Err:%lld%s, Rtt:%lu, Poll:%u (2^%u), ",  offset, interleave.isInterleaved() ? " (I)" : "", rtt, discipline.getPoll(), discipline.getPollExponent());
+    Serial.printf("Jit:%.0f, ADEV:%.2e, Corr:%ld ", discipline.getJitter(), discipline.getAdev(), correction);
     Serial.println();
   }
 }
 
+bool Application::pollUpstream(NTP& ntp) {
+  if (NTS_KE_SERVER[0]) return pollNts(ntp);
+  IPAddress ip;
+  if (!WiFi.hostByName(POOL_NTP, ip)) return false;
+  const uint32_t addr = ip;
+  for (const auto& server : servers) {
+    if (server.denied && !memcmp(server.refId, &addr, 4)) return false;  // the pool will give another one.
+  }
+  sendNTP(ntp, Endpoint{ addr, PORT_NTP });
+  return true;
+}
+
+bool Application::pollNts(NTP& ntp) {
+  if (!nts.isReady()) {
+    TlsChannel channel;
+    if (!channel.connect(NTS_KE_SERVER, NTS_KE_PORT) || !nts.exchange(channel)) {
+      Serial.println("NTS-KE failed");
+      return false;
+    }
+    Serial.printf("NTS-KE: %u cookies, server %s:%u\n", nts.getCookies(), nts.getServer()[0] ? nts.getServer() : NTS_KE_SERVER, nts.getPort());
+  }
+
+  IPAddress ip;
+  if (!WiFi.hostByName(nts.getServer()[0] ? nts.getServer() : NTS_KE_SERVER, ip)) return false;
+  uint8_t buffer[NTP_MAX_PACKET];
+  interleave.prepare(ntp);
+  ntp.setT0(transport.now());
+  const size_t size = nts.prepare(ntp, buffer);
+  if (!size || !transport.send(buffer, size, Endpoint{ uint32_t(ip), nts.getPort() })) return false;
+  interleave.sent(ntp, transport.lastTransmit());
+  return true;
+}
+
+void Application::onKiss(const NTP& ntp) {
+  const char* const code = ntp.getId();
+  const uint8_t* const ip = (const uint8_t*)&upstream.ip;
+  Serial.printf("KoD %.4s from %u.%u.%u.%u\n", code, ip[0], ip[1], ip[2], ip[3]);
+
+  if (!memcmp(code, "RATE", 4)) {
+    discipline.backoff(ntp.getPolling());
+  } else if (!memcmp(code, "DENY", 4) || !memcmp(code, "RSTR", 4)) {
+    NTPServer* const entry = addServer((const char*)&upstream.ip, ntp.getPolling(), time.getEpoch());
+    if (entry) entry->denied = true;
+    saveState(time.getEpoch(), true);
+  }
+}
+
+long Application::correct(const int64_t offset, const unsigned long epoch, const bool accept) {
+  const long correction = discipline.update(offset, epoch, accept);
+  slew(correction);
+  if (accept) lastMeasure = epoch;
+
+  if (THERMAL_COMPENSATION && accept && discipline.hasFrequency() && thermalCount) {
+    thermal.learn(thermalSum / thermalCount, discipline.getLastFrequency());  // mean temperature of the interval.
+  }
+  thermalSum = 0;
+  thermalCount = 0;
+  return correction;
+}
+
+void Application::sampleTemperature() {
+  float celsius;
+  if (!sensor.read(celsius)) return;
+  thermalSum += celsius;
+  ++thermalCount;
+
+  double ppm;
+  const bool valid = thermal.predict(celsius, ppm);
+  discipline.setPrediction(valid, ppm);
+}
+
+void Application::slew(const long correction) {
+  if (correction != 0) {
+    const auto d = correction / 1000000;
+    const auto m = correction - d * 1000000;
+    time.setTime(time.getEpoch() + d, time.getMicros() + m);
+    alarms.rearm();
+  }
+}
+
+void Application::stepTo(const NTP& ntp) {
+  const auto t = ntp.getT2();
+  const auto d = (t - YEAR1970 * 1000000) / 1000000;
+  const auto m = (t - YEAR1970 * 1000000) - d * 1000000;
+  time.setTime(d, m);
+  alarms.rearm();
+  interleave.reset();   // the previous exchange predates the step.
+  discipline.resync(d);
+  lastSync = d;
+}
+
+void Application::checkWiFi(const unsigned long epoch) {
+  wifi_ap_record_t ap_info;
+  if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) return;
+  if (epoch - lastRetry < WIFI_RETRY) return;
+  lastRetry = epoch;
+
+  wifi_config_t config;   // reconnect to any access point of the SSID, not only the cached one.
+  if ((esp_wifi_get_config(WIFI_IF_STA, &config) == ESP_OK) && config.sta.bssid_set) {
+    config.sta.bssid_set = false;
+    config.sta.channel = 0;
+    config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+    esp_wifi_set_config(WIFI_IF_STA, &config);
+    if (WIFI_STATIC_IP) esp_netif_dhcpc_start(esp_netif_get_handle_from_ifkey("WIFI_STA_DEF"));
+  }
+  esp_wifi_connect();   // the association completes in the background.
+}
+
+void Application::onPeer(const Peer& peer) {
+  const auto epoch = time.getEpoch();
+  if (epoch - lastSync <= UPSTREAM_TIMEOUT * discipline.getPoll()) return;  // upstream still alive.
+
+  const uint32_t self = WiFi.localIP();
+  if ((peer.getStratum() >= MAXSTRAT) || !memcmp(peer.getRefId(), &self, 4)) return;  // unsynchronized or synced to us.
+
+  for (const auto& other : peers) {  // best peer only: lowest root distance.
+    if (!other.isConfigured() || !other.isReachable() || (&other == &peer) || (other.getStratum() >= MAXSTRAT)) continue;
+    if (!memcmp(other.getRefId(), &self, 4)) continue;
+    if (other.getDistance() < peer.getDistance()) return;
+  }
+
+  const long correction = correct(peer.getOffset(), epoch, true);
+  const auto ip = peer.getAddress().ip;
+  const auto& packet = peer.getPacket();
+  discipline.setRoot(packet.getRootDelay(), packet.getRootDispersion(), peer.getDelay(), uint32_t(packet.getPrecision() * 1e6) + 1, epoch);
+  responder.update(packet, (const char*)&ip, discipline.getPollExponent(), transport.now());
+  responder.setRoot(discipline.getRootDelay(), discipline.getRootDispersion(epoch));
+  publishState();
+  Serial.printf("Peer Err:%lld, Delay:%lu, Stratum:%u, Corr:%ld\n", peer.getOffset(), peer.getDelay(), peer.getStratum(), correction);
+}
+
+void Application::updateLeap(const uint8_t li, const unsigned long epoch) {
+  leap.update(li, epoch);
+  responder.setLeap(leap.announce());
+  if (!leapExpired && leap.isExpired(epoch)) {
+    Serial.println("Leap second table expired: only the upstream LI bits are used, update LEAPS");
+    leapExpired = true;
+  }
+}
+
+void Application::publishState() {
+  SyncSnapshot s = {};
+  s.leap = leap.announce();
+  s.stratum = responder.isSynchronized() ? responder.getStratum() : MAXSTRAT;
+  s.precision = LOCAL_PRECISION;
+  s.poll = discipline.getPollExponent();
+  memcpy(s.refId, &upstream.ip, 4);
+  s.refTime = transport.now();
+  s.offset = discipline.getOffset() / 1000.0;
+  s.jitter = discipline.getJitter() / 1000.0;
+  s.frequency = discipline.getFrequency();
+  s.adev = discipline.getAdev();
+  s.rootDelay = discipline.getRootDelay() / 1000.0;
+  s.rootDisp = discipline.getRootDispersion(time.getEpoch()) / 1000.0;
+  for (const auto& server : servers) {
+    if (!server.stratum || (s.assocs == CONTROL_ASSOCS)) continue;
+    auto& a = s.assoc[s.assocs++];
+    memcpy(a.address, server.refId, 4);
+    a.stratum = server.stratum;
+    a.hpoll = server.hpoll;
+    a.ppoll = exponent(server.poll);
+    a.selected = !memcmp(server.refId, &upstream.ip, 4);
+    a.offset = server.offset / 1000.0;
+    a.delay = server.rtt / 1000.0;
+    a.jitter = server.jitter / 1000.0;
+  }
+  for (const auto& peer : peers) {
+    if (!peer.isConfigured() || !peer.isReachable() || (s.assocs == CONTROL_ASSOCS)) continue;
+    auto& a = s.assoc[s.assocs++];
+    memcpy(a.address, &peer.getAddress().ip, 4);
+    a.stratum = peer.getStratum();
+    a.hpoll = discipline.getPollExponent();   // onPeerPoll() reschedules each peer at the system poll.
+    a.ppoll = exponent(peer.getPacket().getPolling());
+    a.selected = false;
+    a.offset = peer.getOffset() / 1000.0;
+    a.delay = peer.getDelay() / 1000.0;
+    a.jitter = 0;
+  }
+  control.publish(s);
+}
+
+void Application::serveNTP() {
+  uint8_t buffer[CONTROL_SIZE];
+  Endpoint client;
+  uint64_t rx;
+  const int64_t polled = esp_timer_get_time();
+  const int len = server.receive(buffer, sizeof(buffer), client, rx);
+  if (len > 0 && lastServe) stampStats.add(polled - lastServe);  // the packet waited at most this long before T3.
+  lastServe = polled;
+  if (len <= 0) return;
+
+  if ((buffer[0] & 0b0111) == NTPMODE_CONTROL_MESSAGE) {
+    uint8_t reply[CONTROL_SIZE];
+    const auto size = control.respond(buffer, len, reply);
+    if (size && (limiter.check(client.ip, millis()) == RATE_PASS)) server.send(reply, size, client);
+    return;
+  }
+  if (len < NTP::packetSize()) return;
+
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  request.setPacket(buffer, len);
+  request.setT3(rx);
+  if (request.getKeyId() && !keys.verify(request)) return;  // unknown key or bad MAC.
+
+  if (request.getMode() == NTPMODE_SERVER) {   // reply to the broadcast calibration exchange.
+    if (NTP_KEY_ID && (request.getKeyId() != NTP_KEY_ID)) return;
+    if (BROADCAST_CLIENT && broadcastClient.calibrate(request, client)) {
+      Serial.printf("Bcast calibrated, Delay:%lu\n", broadcastClient.getDelay());
+    }
+    return;
+  }
+
+  if (request.getMode() == NTPMODE_BROADCAST) {
+    if (NTP_KEY_ID && (request.getKeyId() != NTP_KEY_ID)) return;  // a broadcast server must authenticate, like peers.
+    if (BROADCAST_CLIENT) onBroadcast(request, client);
+    return;
+  }
+
+  if ((request.getMode() == NTPMODE_SYMMETRIC_ACTIVE) || (request.getMode() == NTPMODE_SYMMETRIC_PASSIVE)) {
+    if (NTP_KEY_ID && (request.getKeyId() != NTP_KEY_ID)) return;  // peers must authenticate.
+    for (auto& peer : peers) {
+      if (peer.isConfigured() && (peer.getAddress().ip == client.ip)) {
+        if (peer.receive(request)) onPeer(peer);
+        return;
+      }
+    }
+    if (request.getMode() != NTPMODE_SYMMETRIC_ACTIVE) return;
+    if (limiter.check(client.ip, millis()) != RATE_PASS) return;
+    NTP reply = NTP::makeNTP(NTPMODE_SYMMETRIC_PASSIVE);  // ephemeral passive association.
+    responder.symmetric(reply, NTPMODE_SYMMETRIC_PASSIVE);
+    reply.setOrigin(request);
+    reply.setT1(request.getT3());
+    reply.setKeyId(request.getKeyId());
+    server.send(reply, client);
+    return;
+  }
+
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  if (!responder.respond(request, reply)) return;
+  reply.setKeyId(request.getKeyId());
+
+  switch (limiter.check(client.ip, millis())) {
+    case RATE_PASS:
+      if (interleaveServer.prepare(client, request, reply)) {
+        if (reply.getKeyId()) keys.sign(reply);
+        server.send(reply.packetAddr(), reply.length(), client);
+      } else {
+        server.send(reply, client);
+      }
+      interleaveServer.sent(client, reply, server.lastTransmit());
+      break;
+    case RATE_KOD:
+      responder.kiss(request, reply, "RATE");
+      reply.setKeyId(request.getKeyId());
+      server.send(reply, client);
+      break;
+    case RATE_DROP:
+      break;
+  }
+}
+
+void Application::onBroadcast(const NTP& packet, const Endpoint& from) {
+  if (!broadcastClient.accept(packet, from)) return;
+
+  if (!broadcastClient.isCalibrated()) {   // the exchange leaves from the wheel, serveNTP() must not wait.
+    if (!calibrateTimer.isPending()) wheel.schedule(calibrateTimer, 1);
+    return;
+  }
+
+  const auto offset = broadcastClient.getOffset(packet);
+  const auto epoch = time.getEpoch();
+  const long correction = correct(offset, epoch, true);
+  discipline.setRoot(packet.getRootDelay(), packet.getRootDispersion(), 2 * broadcastClient.getDelay(), uint32_t(packet.getPrecision() * 1e6) + 1, epoch);
+  responder.update(packet, (const char*)&from.ip, discipline.getPollExponent(), transport.now());
+  responder.setRoot(discipline.getRootDelay(), discipline.getRootDispersion(epoch));
+  updateLeap(packet.getLeap(), epoch);
+  lastSync = epoch;   // the broadcast server is our upstream: no peer fallback, no resync after sleep.
+  publishState();
+  Serial.printf("Bcast Err:%lld, Delay:%lu, Corr:%ld\n", offset, broadcastClient.getDelay(), correction);
+}
+
 void Application::setFirstTime() {
   Serial.println(__PRETTY_FUNCTION__);
-  NTP ntp = NTP::makeNTP(NTPMODE_CLIENT, 3);
   while (true) {
 //        Serial.println(time.getDateTime());
-    sendNTP(ntp, POOL_NTP, PORT_NTP);
-    if (waitForNTP(ntp, PORT_NTP, 100)) {
-      const auto t = ntp.getT2();
-      const auto d = (t - YEAR1970 * 1000000) / 1000000;
-      const auto m = (t - YEAR1970 * 1000000) - d * 1000000;
-      time.setTime(d, m);
+    NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+    pollUpstream(ntp);
+    if (waitForNTP(ntp, 100)) {
+      stepTo(ntp);
       break;
     }
 
@@ -165,9 +554,279 @@ void Application::setFirstTime() {
 }
 
 void Application::setup() {
+  if (DUTY_CYCLE) {
+    sleepClock.calibrate(rtc_time_get(), esp_timer_get_time());
+    wakeUp();   // returns only after a cold boot.
+  }
   splashScreen();
-  initWiFi();
-  setFirstTime();
+  const bool warm = restoreState();
+  const bool initialized = initWiFi();
+  initTransport();
+  char list[] = PEERS;
+  byte n = 0;
+  for (char* p = strtok(list, ","); p && (n < MAX_PEERS); p = strtok(nullptr, ",")) {
+    IPAddress ip;
+    if (ip.fromString(p)) peers[n++].configure(Endpoint{ uint32_t(ip), PORT_NTP });
+  }
+
+  if (BROADCAST_CLIENT) server.beginMulticast(BROADCAST_GROUP, PORT_NTP);
+  else server.begin(PORT_NTP);
+  if (initialized && !warm) setFirstTime();  // a warm start shows its time at once and steps on the first reply.
+
+  startJobs();
+  alarms.begin();
+  if (DUAL_CORE) {  // rendering leaves the network and discipline alone on the loop() core.
+    tft.fillScreen(TFT_BLACK);
+    xTaskCreatePinnedToCore(displayTask, "display", 4096, this, 1, &display, DISPLAY_CORE);
+    if (TICK_TIMER) ticker.begin();
+  }
+}
+
+void Application::initTransport() {
+  if (NTP_KEY_ID) {
+    static const uint8_t key[] = NTP_KEY;
+    keys.add(NTP_KEY_ID, NTP_KEY_TYPE, key, sizeof(key) - 1);
+  }
+  transport.setKeyring(&keys);
+  server.setKeyring(&keys);
+  server.setLeap(&leap);
+  transport.begin(PORT_LOCAL);
+}
+
+void Application::wakeUp() {
+  if (!sleepClock.isValid() || (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER)) return;
+
+  const uint64_t now = sleepClock.wake(rtc_time_get());
+  time.setTime(now / 1000000 - YEAR1970, now % 1000000);
+  lastSync = sleepClock.getLastSync();
+  const auto epoch = time.getEpoch();
+  if (epoch < sleepClock.getNextPoll()) {   // display refresh only.
+    displayTime(snapshot(epoch));
+    goToSleep();
+  }
+
+  const auto start = esp_timer_get_time();
+  sleepClock.setNextPoll(epoch + DUTY_POLL);
+  if (initWiFi()) {
+    initTransport();
+    NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+    if (pollUpstream(ntp) && waitForNTP(ntp, DUTY_AWAKE * 1000)) {
+      const auto offset = ntp.getOffset();
+      const uint32_t error = ntp.getRootDelay() / 2 + ntp.getRootDispersion() + ntp.getRTT() / 2;
+      const uint64_t slept = retained.slept;
+      sleepClock.learn(offset, time.getEpoch(), error);
+      slew(offset);   // the sleep estimate is replaced, not disciplined.
+      lastSync = time.getEpoch();
+      Serial.printf("Wake Err:%lld, Slept:%llu, RTC:%.6f us %+.1f ppm, Awake:%lld ms\n", offset, slept, sleepClock.getPeriod(), sleepClock.getPpm(), (esp_timer_get_time() - start) / 1000);
+    }
+  }
+  tft.fillScreen(TFT_BLACK);
+  displayTime(snapshot(time.getEpoch()));
+  goToSleep();
+}
+
+void Application::goToSleep() {
+  const uint64_t ticks = rtc_time_get();
+  sleepClock.calibrate(ticks, esp_timer_get_time());
+  const auto epoch = time.getEpoch();
+  if (!sleepClock.isValid()) {
+    sleepClock.reset(double(rtc_clk_cal(RTC_CAL_RTC_MUX, 1024)) / (1 << RTC_CLK_CAL_FRACT), lastSync, discipline.getMaxError(epoch), DUTY_POLL);
+  }
+
+  const auto micros = time.getMicros();
+  sleepClock.sleep((uint64_t(epoch) + YEAR1970) * 1000000 + micros, ticks);
+
+  unsigned long next = (epoch / DUTY_DISPLAY + 1) * DUTY_DISPLAY;   // next display refresh, on the minute.
+  if (next > sleepClock.getNextPoll()) next = sleepClock.getNextPoll();
+  if (next <= epoch) next = epoch + 1;
+  esp_sleep_enable_timer_wakeup(uint64_t(next - epoch) * 1000000 - micros);
+  esp_deep_sleep_start();
+}
+
+void Application::onDisplay(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  const auto published = app.server.now() / 1000000 - YEAR1970;  // smeared if LEAP_SMEAR.
+  if (!DUAL_CORE) {
+    app.boundaryStats.add(app.time.getMicros());
+    app.displayTime(app.snapshot(published));
+  } else if (TICK_TIMER) {
+    app.frames.push(app.nextSnapshot(published));  // drawn by the display task on the next tick.
+  } else if (app.frames.push(app.snapshot(published))) {
+    xTaskNotifyGive(app.display);
+  }
+  app.wheel.schedule(entry, 1);
+}
+
+void Application::onPoll(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  if (!app.broadcastClient.isCalibrated()) {
+    NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+    app.pollUpstream(ntp);
+  }
+  app.wheel.schedule(entry, jitter(app.discipline.getPoll()));
+}
+
+void Application::onPeerPoll(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  Peer& peer = app.peers[&entry - app.peerTimers];
+  NTP ntp = NTP::makeNTP(NTPMODE_SYMMETRIC_ACTIVE);
+  app.responder.symmetric(ntp, NTPMODE_SYMMETRIC_ACTIVE);
+  peer.prepare(ntp);
+  ntp.setKeyId(NTP_KEY_ID);
+  if (app.server.send(ntp, peer.getAddress())) peer.sent(ntp);
+  app.wheel.schedule(entry, jitter(app.discipline.getPoll()));
+}
+
+void Application::onSendBroadcast(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  NTP ntp = NTP::makeNTP(NTPMODE_BROADCAST);
+  if (app.responder.broadcast(ntp)) {
+    ntp.setKeyId(NTP_KEY_ID);   // signed by the transport after the Transmit stamp.
+    app.server.send(ntp, BROADCAST_GROUP, PORT_NTP);
+  }
+  app.wheel.schedule(entry, BROADCAST_INTERVAL);
+}
+
+void Application::onCalibrate(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  if (app.broadcastClient.isCalibrated()) return;
+  NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+  ntp.setKeyId(NTP_KEY_ID);
+  if (app.server.send(ntp, Endpoint{ app.broadcastClient.getServer().ip, PORT_NTP })) app.broadcastClient.sent(ntp);
+}   // not rescheduled: the next broadcast heard retries if no reply came.
+
+void Application::onThermal(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  app.sampleTemperature();
+  app.wheel.schedule(entry, THERMAL_PERIOD);
+}
+
+void Application::onFlush(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  if (app.discipline.hasFrequency()) app.saveState(app.time.getEpoch());
+  app.wheel.schedule(entry, DRIFT_INTERVAL);
+}
+
+void Application::onReport(TimerEntry& entry) {
+  Application& app = *(Application*)entry.context;
+  LatencyStats& stats = app.stampStats;
+  if (stats.getCount()) {
+    Serial.printf("T3 stamp delay (%s): n=%u, mean %.0f us, sd %.0f us, max %lld us\n", DUAL_CORE ? "split" : "single core",
+      stats.getCount(), stats.getMean(), stats.getDeviation(), stats.getMax());
+    stats.reset();
+  }
+  if (!DUAL_CORE) app.reportBoundary();
+  app.wheel.schedule(entry, STAMP_REPORT);
+}
+
+bool Application::setCronAlarm(CronAlarm& job, const char expression[]) {
+  alarms.cancel(job.alarm);
+  if (!job.expression.compile(expression)) return false;
+  job.owner = this;
+  job.alarm.callback = onCron;
+  job.alarm.context = &job;
+  const time_t next = job.expression.nextFire(time.getEpoch(), timezone);
+  return next && setAlarm(job.alarm, next);
+}
+
+void Application::onCron(Alarm& alarm) {
+  CronAlarm& job = *(CronAlarm*)alarm.context;
+  const time_t next = job.expression.nextFire(alarm.when / 1000000, job.owner->timezone);
+  if (next) job.owner->setAlarm(alarm, next);   // computed once per fire, not polled.
+  if (job.callback) job.callback(job);
+}
+
+unsigned Application::jitter(const unsigned period) {
+  return period - period / 16 + esp_random() % (period / 8 + 1);  // +/- 6 %: clients do not poll in step.
+}
+
+uint8_t Application::exponent(const unsigned period) {
+  return period ? 31 - __builtin_clz(period) : 0;
+}
+
+void Application::startJobs() {
+  wheel.schedule(displayTimer, 1);
+  wheel.schedule(pollTimer, 1 + esp_random() % discipline.getPoll());
+  for (byte i = 0; i < MAX_PEERS; ++i) {
+    if (peers[i].isConfigured()) wheel.schedule(peerTimers[i], 1 + esp_random() % discipline.getPoll());
+  }
+  if (BROADCAST_INTERVAL && !BROADCAST_CLIENT) wheel.schedule(broadcastTimer, BROADCAST_INTERVAL);
+  if (THERMAL_COMPENSATION) wheel.schedule(thermalTimer, THERMAL_PERIOD);
+  if (DRIFT_INTERVAL) wheel.schedule(flushTimer, DRIFT_FIRST);
+  if (STAMP_REPORT) wheel.schedule(reportTimer, STAMP_REPORT);
+}
+
+void Application::displayTask(void* app) {
+  Application& self = *(Application*)app;
+  TimeSnapshot now, frame, ahead;
+  bool early = false;   // a frame pushed ahead is waiting for its second.
+  while (true) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    const auto micros = self.time.getMicros();
+    const auto current = self.time.getEpoch();
+
+    bool fresh = early && (ahead.due <= current);
+    if (fresh) {
+      now = ahead;
+      early = false;
+    }
+    while (self.frames.pop(frame)) {  // late frames are skipped, only the newest is drawn.
+      if (frame.due > current) {
+        ahead = frame;
+        early = true;
+      } else {
+        now = frame;
+        fresh = true;
+      }
+    }
+    if (!fresh) continue;
+
+    self.boundaryStats.add(micros);
+    self.displayTime(now);
+    if (STAMP_REPORT && !(current % STAMP_REPORT)) self.reportBoundary();
+  }
+}
+
+void Application::onTick(void* app) {
+  xTaskNotifyGive(((Application*)app)->display);
+}
+
+void Application::reportBoundary() {
+  if (!boundaryStats.getCount()) return;
+  Serial.printf("Second boundary latency (%s): n=%u, mean %.0f us, sd %.0f us, max %lld us\n", DUAL_CORE && TICK_TIMER ? "timer" : "loop",
+    boundaryStats.getCount(), boundaryStats.getMean(), boundaryStats.getDeviation(), boundaryStats.getMax());
+  boundaryStats.reset();
+}
+
+bool Application::restoreState() {
+  DriftRecord record;
+  if (!DRIFT_INTERVAL || !drift.load(record)) return false;
+
+  discipline.restore(record.frequency);
+  for (uint8_t i = 0; i < record.count; ++i) {
+    NTPServer* const entry = addServer((const char*)record.servers[i].ip, record.servers[i].poll, 0);
+    if (entry) entry->denied = record.servers[i].denied;
+  }
+  const bool reset = time.getEpoch() < record.epoch;  // else the RTC kept running through a soft reset.
+  if (reset) time.setTime(record.epoch);
+  Serial.printf("Warm start: %+.3f ppm, %u servers%s\n", record.frequency, record.count, reset ? ", last known time" : "");
+  return true;
+}
+
+void Application::saveState(const unsigned long epoch, const bool force) {
+  if (!DRIFT_INTERVAL || !lastSync) return;  // never overwrite a good record with an unsynchronized time.
+  DriftRecord record = {};
+  record.frequency = discipline.getFrequency();
+  record.epoch = epoch;
+  for (const auto& server : servers) {
+    if (!server.stratum && !server.denied) continue;
+    if (record.count == DRIFT_SERVERS) break;
+    auto& saved = record.servers[record.count++];
+    memcpy(saved.ip, server.refId, 4);
+    saved.denied = server.denied;
+    saved.poll = server.poll > UINT16_MAX ? UINT16_MAX : server.poll;
+  }
+  if (drift.save(record, force)) Serial.printf("Drift saved: %+.3f ppm\n", record.frequency);
 }
 
 void Application::splashScreen() {  
@@ -189,17 +848,49 @@ void Application::splashScreen() {
   tft.setTextDatum(BC_DATUM);
   tft.setTextColor(TFT_WHITE);
   tft.drawString(c, tft.width() / 2, 135, 2);
-  delay(5000);
+  splashEnd = esp_timer_get_time() + SPLASH_TIME * 1000LL;
+}
+
+TimeSnapshot Application::snapshot(const unsigned long epoch) {
+  TimeSnapshot now;
+  now.due = time.getEpoch();
+  now.epoch = epoch;
+  now.local = timezone.localtime(epoch);
+  now.maxError = getMaxError();
+  now.leapSecond = leap.isLeapSecond();
+  now.holdover = isHoldover(epoch);
+  return now;
 }
 
-void Application::displayTime(const unsigned long& epoch) {
+TimeSnapshot Application::nextSnapshot(const unsigned long epoch) {
+  const auto when = leap.getTime();
+  unsigned long next = epoch + 1;
+  bool repeat = false;
+  if (when && (next == when) && (leap.announce() == 1)) {  // 23:59:60 follows.
+    next = epoch;
+    repeat = true;
+  } else if (when && (next + 1 == when) && (leap.announce() == 2)) {  // 23:59:59 is skipped.
+    next = when;
+  }
+  TimeSnapshot now = snapshot(next);
+  now.due += 1;
+  now.leapSecond = repeat;
+  return now;
+}
+
+void Application::displayTime(const TimeSnapshot& now) {
   static const char *const days[] = { "Dim", "Lun", "Mar", "Mer", "Jeu", "Ven", "Sam" };
   static const char *const months[] = { "Janv.", "Fevr.", "Mars", "Avril", "Mai", "Juin", "Juil.", "Aout", "Sept.", "Octo.", "Nove.", "Dece." };
   struct tm tmUTC, tmLocal;
 
-  gmtime_r( (const time_t*)(&epoch), &tmUTC );
-  const auto epochLocal = timezone.localtime(epoch);
-  gmtime_r( (const time_t*)(&epochLocal), &tmLocal );
+  const time_t epoch = now.epoch;
+  const time_t epochLocal = now.local;
+  gmtime_r( &epoch, &tmUTC );
+  gmtime_r( &epochLocal, &tmLocal );
+  if (now.leapSecond) {  // 23:59:59 repeated: inserted second.
+    tmUTC.tm_sec = 60;
+    tmLocal.tm_sec = 60;
+  }
 
   char str[100];
     
@@ -220,6 +911,15 @@ void Application::displayTime(const unsigned long& epoch) {
   if (snprintf(str, sizeof(str), "%s. %02d %s %d", days[tmLocal.tm_wday], tmLocal.tm_mday, months[tmLocal.tm_mon], tmLocal.tm_year + 1900) > 0)
     tft.drawString(str, tft.width()/2, tft.height() - 18, 4);
 
+// Borne d'erreur maximale.
+  tft.setTextDatum(TR_DATUM);
+  tft.setTextColor(TFT_DARKGREY, TFT_BLACK);
+  const auto error = now.maxError;
+  const char* const state = now.holdover ? "HOLD " : "";
+  if (error == UINT32_MAX) snprintf(str, sizeof(str), "  %s+/- ? ms", state);
+  else snprintf(str, sizeof(str), "  %s+/-%.1f ms", state, error / 1000.0);
+  tft.drawString(str, tft.width(), 0, 2);
+
 // Date et heure UTC.
   tft.setTextDatum(BC_DATUM);
   tft.setTextColor(TFT_BLUE, TFT_BLACK);
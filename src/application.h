@@ -21,15 +21,84 @@
 #define TOUCH_CS 0xFF
 #include <TFT_eSPI.h>
 #include <WiFi.h>
-#include <WiFiUdp.h>
+#include <esp_wifi.h>
+#include <esp_netif.h>
 #include <ESP32Time.h>
 #include "ntp.h"
+#include "wifi_transport.h"
+#include "responder.h"
+#include "ratelimit.h"
+#include "broadcast.h"
+#include "control.h"
+#include "peer.h"
+#include "interleaved.h"
+#include "auth.h"
 #include "timezone.h"
+#include "discipline.h"
+#include "leap.h"
+#include "thermal.h"
+#include "drift.h"
+#include "sleep.h"
+#include "wifi_cache.h"
+#include "spsc.h"
+#include "latency.h"
+#include "tick.h"
+#include "wheel.h"
+#include "alarm.h"
+#include "cron.h"
+#include "nts.h"
+#include "tls_channel.h"
 
 #include "secrets.h"
 
 #define POOL_NTP "fr.pool.ntp.org"
 #define PORT_NTP 123
+#define PORT_LOCAL 1024
+
+#define NTS_KE_SERVER ""              // NTS-KE server (RFC 8915, e.g. "time.cloudflare.com"): polled with NTS instead of POOL_NTP.
+#define NTS_KE_PORT 4460              // TCP port of the NTS-KE server.
+
+#define BROADCAST_GROUP "224.0.1.1"   // IANA NTP multicast group.
+#define BROADCAST_INTERVAL 64         // [s], 0 disables broadcasting.
+#define BROADCAST_CLIENT 0            // 1 to listen to broadcasts instead of polling POOL_NTP.
+
+#define PEERS ""                      // Comma separated IPv4 addresses of symmetric peers (other units of the site).
+#define MAX_PEERS 4
+#define UPSTREAM_TIMEOUT 4            // Polls without upstream reply before falling back on peers (or holdover).
+
+#define WIFI_TIMEOUT 30               // [s] to wait for the association at startup.
+#define WIFI_RETRY 30                 // [s] between background reconnection attempts.
+#define WIFI_FAST_CONNECT 1           // 1 to connect first to the cached access point (BSSID and channel, no scan).
+#define WIFI_FAST_TIMEOUT 3000        // [ms] for the cached access point before falling back on a full scan.
+#define WIFI_STATIC_IP 0              // 1 to reuse the cached DHCP lease as a static address (needs a DHCP reservation).
+#define SPLASH_TIME 5000              // [ms] the splash screen stays up at startup, while the WiFi associates.
+
+#define LEAP_SMEAR 0                  // 1 to smear leap seconds over 24 h instead of showing 23:59:60.
+#define LEAP_TABLE 1                  // 1 to also use the bundled leap second table (not only the upstream LI bits).
+
+#define THERMAL_COMPENSATION 1        // 1 to learn the crystal frequency versus temperature and feed it forward.
+#define THERMAL_PERIOD 16             // [s] between two temperature samples.
+
+#define DRIFT_INTERVAL 3600           // [s] between two writes of the drift record to NVS, 0 disables warm starts.
+#define DRIFT_FIRST 300               // [s] after startup for the first write.
+
+#define DUTY_CYCLE 0                  // 1 for battery units: deep sleep between polls, time kept by the RTC.
+#define DUTY_POLL 900                 // [s] between two wake-ups with a poll (duty cycle).
+#define DUTY_DISPLAY 60               // [s] between two display refreshes (duty cycle).
+#define DUTY_AWAKE 5                  // [s] maximum wait for the reply (duty cycle).
+
+#define DUAL_CORE 1                   // 1 to render the display in its own task, on the other core than loop().
+#define DISPLAY_CORE 0                // Core of the display task (loop() runs on core 1).
+#define TICK_TIMER 1                  // 1 to draw each second on an esp_timer tick (needs DUAL_CORE), not when loop() sees it.
+#define STAMP_REPORT 64               // [s] between two reports of the T3 stamping and second boundary delays, 0 disables them.
+
+#define ALARM_CAPACITY 1024           // Maximum number of pending alarms (one pointer each).
+
+#ifndef NTP_KEY_ID                    // Symmetric key, usually defined in secrets.h.
+#define NTP_KEY_ID 0                  // 0 disables authentication of the upstream and peers.
+#define NTP_KEY_TYPE AUTH_SHA1        // AUTH_SHA1 or AUTH_AES_CMAC (16 bytes key).
+#define NTP_KEY ""
+#endif
 
 
 /**
@@ -37,8 +106,44 @@
  */
 struct NTPServer {
   char          refId[4];
-  unsigned      poll;
+  unsigned      poll;       // announced by the server [s].
   unsigned long lastPoll;
+  uint8_t       hpoll;      // exponent of our polling interval when it last answered.
+  uint8_t       stratum;
+  int64_t       offset;   // [µs]
+  unsigned long rtt;      // [µs]
+  double        jitter;   // [µs]
+  bool          denied;   // Kiss-o'-Death DENY or RSTR: never polled again.
+};
+
+/**
+ * What the display needs to draw one second, so that it can run on another core without touching the
+ * discipline.
+ */
+struct TimeSnapshot {
+  unsigned long due;        // Second of the local clock to draw it at [s].
+  unsigned long epoch;      // Published UTC time [s].
+  unsigned long local;      // Local time [s].
+  uint32_t      maxError;   // [µs], UINT32_MAX if unknown.
+  bool          leapSecond; // 23:59:59 repeated, shown as 23:59:60.
+  bool          holdover;
+};
+
+class Application;
+
+/**
+ * Recurring alarm on a cron expression of the local time. Its next fire time is computed once, when it is
+ * scheduled and each time it fires. Owned by the caller, it must stay in place while it is scheduled.
+ */
+struct CronAlarm {
+  CronAlarm(void (*aCallback)(CronAlarm&) = nullptr, void* aContext = nullptr, const uint8_t aPin = ALARM_NO_PIN, const uint8_t aLevel = 1) :
+    expression(), alarm(nullptr, this, aPin, aLevel), callback(aCallback), context(aContext), owner(nullptr) {}
+
+  CronExpression expression;
+  Alarm          alarm;           // Fires the job (reserved to Application).
+  void         (*callback)(CronAlarm&);  // Called in the esp_timer task at each fire.
+  void*          context;         // Free for the caller.
+  Application*   owner;
 };
 
 /**
@@ -61,6 +166,62 @@ class Application {
  */
     void loop();
 
+/**
+ * Return the clock discipline (poll interval, jitter, Allan deviation).
+ * @return A reference to the discipline.
+ */
+    const Discipline& getDiscipline() const { return discipline; }
+
+/**
+ * Return the maximum error of the local clock: root delay / 2 + root dispersion, growing by PHI since the
+ * last accepted measure (by the RTC error bound when duty cycling).
+ * @return A time in microseconds, UINT32_MAX before the first synchronization.
+ */
+    uint32_t getMaxError() {
+      const auto epoch = time.getEpoch();
+      return DUTY_CYCLE && sleepClock.isValid() ? sleepClock.getMaxError(epoch) : discipline.getMaxError(epoch);
+    }
+
+/**
+ * Schedule an alarm at a UTC time. Its callback (if any) runs in the esp_timer task and its pin (if any) is set
+ * within a few tens of µs of the disciplined time, slews and steps included.
+ * @param alarm The alarm, owned by the caller; rescheduled if pending.
+ * @param epoch UTC time [s].
+ * @param period Repeat period [s of UTC], 0 for a one-shot alarm.
+ * @return False if ALARM_CAPACITY alarms are already pending.
+ */
+    bool setAlarm(Alarm& alarm, const unsigned long epoch, const uint32_t period = 0) {
+      return alarms.schedule(alarm, uint64_t(epoch) * 1000000, period);
+    }
+
+/**
+ * Schedule an alarm at a local time of the timezone. A local time skipped in spring fires at the change,
+ * one repeated in autumn fires on its first occurrence unless later is set.
+ * @param alarm The alarm, owned by the caller; rescheduled if pending.
+ * @param local Local time [s].
+ * @param period Repeat period [s of UTC], 0 for a one-shot alarm.
+ * @param later In the autumn overlap, fire on the second occurrence.
+ * @return False if ALARM_CAPACITY alarms are already pending.
+ */
+    bool setLocalAlarm(Alarm& alarm, const time_t local, const uint32_t period = 0, const bool later = false) {
+      return setAlarm(alarm, timezone.utc(local, later), period);
+    }
+
+/**
+ * Schedule a recurring alarm on a cron expression of the local time, e.g. "30 7 * * MON-FRI".
+ * @param job The alarm, owned by the caller; rescheduled if pending.
+ * @param expression Minute, hour, day of month, month and day of week (see CronExpression).
+ * @return False if the expression is invalid or never fires, or if ALARM_CAPACITY alarms are already pending.
+ */
+    bool setCronAlarm(CronAlarm& job, const char expression[]);
+
+/**
+ * Cancel an alarm (no effect if it is not pending).
+ */
+    void cancelAlarm(Alarm& alarm) {
+      alarms.cancel(alarm);
+    }
+
   protected:
 
 /**
@@ -68,8 +229,9 @@ class Application {
  * @param refId reference ID (IP or name).
  * @param polling [s].
  * @param lastPoll UTC time of the last poll.
+ * @return The server's entry, or nullptr if the list is full.
  */
-    void addServer(const char refId[4], const unsigned poll, const unsigned long lastPoll) {
+    NTPServer* addServer(const char refId[4], const unsigned poll, const unsigned long lastPoll) {
       for (byte i = 0; i < 10; ++i) {
 //        char s[50];
 //        snprintf(s, 50, "addServer %d.%d.%d.%d", servers[i].refId[0], servers[i].refId[1], servers[i].refId[2], servers[i].refId[3]);
@@ -79,27 +241,100 @@ class Application {
           servers[i].poll = poll;
           servers[i].lastPoll = lastPoll;
 //          Serial.println(" added");
-          return;
+          return &servers[i];
         } 
         if (memcmp(refId, servers[i].refId, 4) == 0) {
           servers[i].poll = poll;
           servers[i].lastPoll = lastPoll;
 //          Serial.println(" updated");
-          return;
+          return &servers[i];
         }
       }
+      return nullptr;
     }
 
 /**
- * Splash screen explaining the aim of the application.
+ * Splash screen explaining the aim of the application. Does not wait: it stays up for SPLASH_TIME while
+ * initWiFi() associates.
   */
     void splashScreen();
 
+/**
+ * Capture what the display needs for one second.
+ * @param epoch The published time.
+ * @return The snapshot.
+ */
+    TimeSnapshot snapshot(const unsigned long epoch);
+
+/**
+ * Capture what the display needs for the next second, drawn ahead of time on the next tick (TICK_TIMER).
+ * A leap second pending at the end of this second is taken into account.
+ * @param epoch The published time of this second.
+ * @return The snapshot.
+ */
+    TimeSnapshot nextSnapshot(const unsigned long epoch);
+
 /**
  * Display current time (local clock) to the display.
- * @param epoch The current time.
+ * @param now Snapshot of the current second.
+ */
+    void displayTime(const TimeSnapshot& now);
+
+/**
+ * Schedule the periodic jobs on the timer wheel: display, polls (randomized), broadcasts, temperature,
+ * NVS flushes and statistics reports.
+ */
+    void startJobs();
+
+/**
+ * Timer wheel jobs: each one does its work then reschedules itself.
+ * @param entry The job's entry, whose context is the application.
+ */
+    static void onDisplay(TimerEntry& entry);
+    static void onPoll(TimerEntry& entry);
+    static void onPeerPoll(TimerEntry& entry);
+    static void onSendBroadcast(TimerEntry& entry);
+    static void onCalibrate(TimerEntry& entry);
+    static void onThermal(TimerEntry& entry);
+    static void onFlush(TimerEntry& entry);
+    static void onReport(TimerEntry& entry);
+
+/**
+ * Alarm of a CronAlarm: schedule its next fire, then call the job.
+ * @param alarm The job's alarm, whose context is the CronAlarm.
+ */
+    static void onCron(Alarm& alarm);
+
+/**
+ * Randomize a poll interval by +/- 6 % so that a fleet of clients does not poll on the same seconds.
+ * @param period Nominal interval [s].
+ * @return The interval to wait [s].
+ */
+    static unsigned jitter(const unsigned period);
+
+/**
+ * Poll exponent of an interval, as ntpq shows it.
+ * @param period Interval [s], a power of 2.
+ * @return log2(period), 0 for an unknown interval.
+ */
+    static uint8_t exponent(const unsigned period);
+
+/**
+ * Display task (DUAL_CORE): draws the newest snapshot due, when loop() pushes it or on the tick (TICK_TIMER).
+ * @param app The application.
+ */
+    static void displayTask(void* app);
+
+/**
+ * Tick callback (esp_timer task): wake the display task up.
+ * @param app The application.
  */
-    void displayTime(const unsigned long& epoch);
+    static void onTick(void* app);
+
+/**
+ * Print and reset the delay between the second boundary and the start of its frame.
+ */
+    void reportBoundary();
 
 /**
  * Setup local time for the first time until time offset is lower than 1ms (MAX_OFFSET).
@@ -113,59 +348,249 @@ class Application {
  * @param port UDP port.
  */
     void sendNTP(NTP& ntp, const char host[], const unsigned port) {
-      udp.begin(1024);
-      udp.beginPacket(host, port);
-      uint64_t tx = time.getMicros();
-      tx += (time.getEpoch() + YEAR1970) * 1000000ULL;
-      ntp.setT0(tx);
-      udp.write(ntp.packetAddr(), ntp.packetSize());
-      udp.endPacket();
+      interleave.prepare(ntp);
+      ntp.setKeyId(NTP_KEY_ID);
+      if (transport.send(ntp, host, port)) interleave.sent(ntp, transport.lastTransmit());
     }
 
-    bool waitForNTP(NTP& ntp, const unsigned port, const unsigned timeout = 0) {
-      const auto start = millis();
-      while ((udp.parsePacket() < ntp.packetSize()) && (millis() < (start + timeout))) {
-        yield();
+/**
+ * Send a prepared NTP packet to the designed address using UDP.
+ * @param ntp Reference to a NTP packet to be sent.
+ * @param to Server's address and port.
+ */
+    void sendNTP(NTP& ntp, const Endpoint& to) {
+      interleave.prepare(ntp);
+      ntp.setKeyId(NTP_KEY_ID);
+      if (transport.send(ntp, to)) interleave.sent(ntp, transport.lastTransmit());
+    }
+
+/**
+ * Resolve the pool and poll the address obtained, unless that server refused us (Kiss-o'-Death DENY/RSTR).
+ * @param ntp Reference to a NTP packet to be sent.
+ * @return True if the request was sent.
+ */
+    bool pollUpstream(NTP& ntp);
+
+/**
+ * Poll the NTS server with authenticated extension fields, after a new key exchange if the cookie jar ran
+ * empty or the server forgot our cookies (NTSN).
+ * The Transmit stamp is taken before the AEAD tag is computed: in basic mode the offset carries half of that
+ * cost, the interleaved mode removes it.
+ * @param ntp Reference to a NTP packet to be sent.
+ * @return True if the request was sent.
+ */
+    bool pollNts(NTP& ntp);
+
+/**
+ * Wait for a server's reply and run the RFC 5905 sanity checks on it: authentication, origin, format,
+ * Kiss-o'-Death, synchronization, timestamps and root distance.
+ * @param ntp Reference to the NTP packet receiving the reply.
+ * @param timeout Maximum wait [ms].
+ * @return True if a valid reply was received.
+ */
+    bool waitForNTP(NTP& ntp, const unsigned timeout = 0) {
+      if (NTS_KE_SERVER[0]) {   // only authenticated replies, not even a Kiss-o'-Death otherwise.
+        uint8_t buffer[NTP_MAX_PACKET];
+        uint64_t rx;
+        const int len = transport.receive(buffer, sizeof(buffer), upstream, rx, timeout);
+        if ((len < NTP::packetSize()) || !nts.verify(buffer, len)) return false;
+        ntp.setPacket(buffer);
+        ntp.setT3(rx);
+      } else {
+        if (!transport.receive(ntp, upstream, timeout)) return false;
+        if (NTP_KEY_ID && ((ntp.getKeyId() != NTP_KEY_ID) || !keys.verify(ntp))) return false;
       }
-      uint64_t rx = time.getMicros();
-      rx += (time.getEpoch() + YEAR1970) * 1000000;
+      if (!interleave.receive(ntp, discipline.getCorrections())) return false;  // not an answer to our last request.
 
-      if (millis() > (start + timeout)) return false; // timedout without packet.
+      const NtpCheck result = ntp.check();
+      if (result == NTP_CHECK_OK) return true;
+      if (result == NTP_CHECK_KISS) onKiss(ntp);
+      interleave.reset();
+      return false;
+    }
 
-      const auto size = NTP::packetSize();
-      uint8_t buffer[size];
-      const auto nb = udp.read(buffer, size);
-      if (nb == -1) return false; // error reading!
+/**
+ * React to a Kiss-o'-Death from the upstream server: slow down on RATE, stop polling it on DENY or RSTR.
+ * Other codes are ignored (the reply is simply dropped).
+ * @param ntp The kiss packet, whose origin has already been checked.
+ */
+    void onKiss(const NTP& ntp);
 
-      ntp.setPacket(buffer);
-      ntp.setT3(rx);
+/**
+ * Handle a packet received on the NTP port: answer client requests (stratum N+1 server) once the local
+ * clock is synchronized, and listen to broadcasts in broadcast client mode.
+ */
+    void serveNTP();
 
-      if (ntp.getT3() < ntp.getT0()) {
-//        Serial.println("WARNING ! T3 < T0 ");
-        return false;
-      }
-      if (ntp.getT2() < ntp.getT1()) {
-//        Serial.println("WARNING ! T2 < T1 ");
-        return false;
-      }
+/**
+ * Broadcast client: calibrate the one-way delay once with a unicast exchange, then discipline the clock
+ * with each broadcast packet. The exchange is sent from the wheel (onCalibrate) on the server socket and its
+ * reply is taken in serveNTP(), which never waits for it.
+ * @param packet Broadcast packet received.
+ * @param from Sender's address.
+ */
+    void onBroadcast(const NTP& packet, const Endpoint& from);
+
+/**
+ * Symmetric peer: use its measure as the time source while the upstream server is unreachable.
+ * @param peer Peer which just gave a valid measure.
+ */
+    void onPeer(const Peer& peer);
+
+/**
+ * Take the leap indicator of an accepted upstream into account and announce it to the clients.
+ * Logs once when the bundled leap second table has expired.
+ * @param li Leap indicator received.
+ * @param epoch UTC time [s].
+ */
+    void updateLeap(const uint8_t li, const unsigned long epoch);
+
+/**
+ * Publish the synchronization state for mode 6 (control) queries.
+ */
+    void publishState();
+
+/**
+ * Feed an offset to the discipline and slew the local clock accordingly.
+ * @param offset Measured offset [µs].
+ * @param epoch UTC time of the measure [s].
+ * @param accept False if the measure is not reliable enough to correct the clock.
+ * @return The correction applied [µs].
+ */
+    long correct(const int64_t offset, const unsigned long epoch, const bool accept);
+
+/**
+ * Apply a phase correction to the local clock.
+ * @param correction Correction [µs], positive to advance the clock.
+ */
+    void slew(const long correction);
+
+/**
+ * Step the local clock to the server's transmit time (first synchronization).
+ * @param ntp A valid server reply.
+ */
+    void stepTo(const NTP& ntp);
 
-      if (!ntp.getT1() || !ntp.getT2() || ntp.getVersion() != 3 || ntp.getMode() != NTPMODE_SERVER) return false;
+/**
+ * Install the authentication key and open the client and server sockets.
+ */
+    void initTransport();
+
+/**
+ * Duty cycle: after a wake-up from deep sleep, restore the time from the calibrated RTC counter, poll the
+ * upstream server every DUTY_POLL (learning the RTC error), refresh the display and go back to sleep.
+ * Returns only after a cold boot or if the RTC memory was lost.
+ */
+    void wakeUp();
+
+/**
+ * Duty cycle: save the time base to RTC memory and deep sleep until the next display refresh or poll.
+ * Never returns.
+ */
+    void goToSleep();
 
-      return true;
+/**
+ * Warm start: restore the frequency, the associations and, if the RTC was reset, the last known time from NVS.
+ * @return True if a valid record was found, the local time being then plausible.
+ */
+    bool restoreState();
+
+/**
+ * Save the frequency, the last good time and the associations to NVS, at most every DRIFT_INTERVAL.
+ * @param epoch Current UTC time [s].
+ * @param force Write now (rare but important change).
+ */
+    void saveState(const unsigned long epoch, const bool force = false);
+
+/**
+ * Read the internal temperature sensor, accumulate it for the next measure and update the predicted frequency.
+ */
+    void sampleTemperature();
+
+/**
+ * Tell whether the clock is in holdover: synchronized once, but no source accepted for UPSTREAM_TIMEOUT polls.
+ * The clock then free-runs on the thermal model (or the learned frequency) and the error bound keeps growing.
+ * @param epoch Current UTC time [s].
+ * @return True in holdover.
+ */
+    bool isHoldover(const unsigned long epoch) const {
+      return lastMeasure && (epoch - lastMeasure > UPSTREAM_TIMEOUT * discipline.getPoll());
     }
 
 /**
- * Setup WiFi using Application's template WIFI_SSID & WIFI_PASS.
- * @return True if ok or else False.
+ * Retry the WiFi association in the background (non blocking) every WIFI_RETRY seconds while disconnected.
+ * @param epoch Current UTC time [s].
+ */
+    void checkWiFi(const unsigned long epoch);
+
+/**
+ * Setup WiFi using Application's template WIFI_SSID & WIFI_PASS. The cached access point (and lease) is tried
+ * first for WIFI_FAST_TIMEOUT, then a full scan with DHCP. Each phase's duration is logged. Under the splash
+ * screen, progress is only shown once the association is over and the splash has been up for SPLASH_TIME.
+ * @return True if connected within WIFI_TIMEOUT, else False (checkWiFi() keeps trying in the background).
  */
     bool initWiFi();
 
+/**
+ * Wait for the association, then for the IP address.
+ * @param netif Station interface.
+ * @param ap Receives the access point's record.
+ * @param timeout [ms].
+ * @param associated Receives the time of the association [µs, esp_timer], 0 if not associated.
+ * @return True if connected with an IP address before the timeout.
+ */
+    bool waitWiFi(esp_netif_t* const netif, wifi_ap_record_t& ap, const unsigned timeout, int64_t& associated);
+
   private:
     TFT_eSPI tft;
     ESP32Time time;
-    WiFiUDP udp;
+    WiFiTransport transport;
+    WiFiTransport server;
+    Endpoint upstream;
+    Responder responder;
+    RateLimiter limiter;
+    BroadcastClient broadcastClient;
+    ControlResponder control;
+    Keyring keys;
+    NtsClient nts;
+    Peer peers[MAX_PEERS];
+    InterleavedClient interleave;
+    InterleavedServer interleaveServer;
+    unsigned long lastSync;   // UTC time of the last upstream sync [s].
+    unsigned long lastMeasure;  // UTC time of the last accepted measure, any source [s].
+    unsigned long lastRetry;  // UTC time of the last WiFi reconnection attempt [s].
+    int64_t splashEnd;        // End of the splash screen [µs, esp_timer], 0 once it has been replaced.
+    InternalTemperature sensor;
+    ThermalModel thermal;
+    float thermalSum;         // Temperatures sampled since the last measure [°C].
+    unsigned thermalCount;
+    NvsStore driftStore;
+    DriftFile drift;
+    SleepClock sleepClock;
+    NvsStore wifiStore;
+    WiFiCache wifiCache;
+    SpscQueue<TimeSnapshot, 4> frames;  // loop() -> display task.
+    TaskHandle_t display;
+    LatencyStats stampStats;  // Wait of received packets before their T3 stamp [µs].
+    int64_t lastServe;        // Last call of serveNTP() [µs, esp_timer].
+    TickScheduler ticker;
+    LatencyStats boundaryStats;  // Delay from the second boundary to the start of its frame [µs].
+    TimerWheel wheel;         // Advanced once per second of the local clock.
+    TimerEntry displayTimer;
+    TimerEntry pollTimer;
+    TimerEntry peerTimers[MAX_PEERS];
+    TimerEntry broadcastTimer;
+    TimerEntry calibrateTimer;
+    TimerEntry thermalTimer;
+    TimerEntry flushTimer;
+    TimerEntry reportTimer;
+    Alarm* alarmSlots[ALARM_CAPACITY];
+    AlarmScheduler alarms;    // Alarms at the disciplined UTC time, re-armed after each clock correction.
+    Leap leap;
+    bool leapExpired;         // the expiry of the leap second table has been logged.
     Timezone timezone;
     NTPServer servers[10];
+    Discipline discipline;
 };
 
 
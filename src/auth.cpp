@@ -0,0 +1,113 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "auth.h"
+
+#include <mbedtls/cmac.h>
+
+#define SHA1_SIZE 20
+#define CMAC_SIZE 16
+#define CMAC_KEY 16
+
+Keyring::Keyring() :
+  count(0)
+{
+  for (auto& k : keys) {
+    k.id = 0;
+    mbedtls_sha1_init(&k.sha1);
+    mbedtls_cipher_init(&k.cmac);
+  }
+}
+
+Keyring::~Keyring() {
+  for (auto& k : keys) {
+    mbedtls_sha1_free(&k.sha1);
+    mbedtls_cipher_free(&k.cmac);
+  }
+}
+
+bool Keyring::add(const uint32_t id, const AuthType type, const uint8_t key[], const size_t len) {
+  if (!id || find(id) || (count == MAX_KEYS)) return false;
+  Key& k = keys[count];
+
+  switch (type) {
+    case AUTH_SHA1:
+      if (mbedtls_sha1_starts(&k.sha1) || mbedtls_sha1_update(&k.sha1, key, len)) return false;
+      break;
+    case AUTH_AES_CMAC:
+      if ((len != CMAC_KEY)
+       || mbedtls_cipher_setup(&k.cmac, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB))
+       || mbedtls_cipher_cmac_starts(&k.cmac, key, CMAC_KEY * 8)) return false;
+      break;
+  }
+  k.id = id;
+  k.type = type;
+  ++count;
+  return true;
+}
+
+Keyring::Key* Keyring::find(const uint32_t id) {
+  for (byte i = 0; i < count; ++i) {
+    if (keys[i].id == id) return &keys[i];
+  }
+  return nullptr;
+}
+
+byte Keyring::digest(Key& key, const NTP& ntp, uint8_t mac[NTP_MAX_MAC]) {
+  const auto data = ntp.packetAddr();
+  const auto size = NTP::packetSize();
+
+  switch (key.type) {
+    case AUTH_SHA1: {
+      mbedtls_sha1_context ctx;
+      mbedtls_sha1_init(&ctx);
+      mbedtls_sha1_clone(&ctx, &key.sha1);
+      const bool ok = !mbedtls_sha1_update(&ctx, data, size) && !mbedtls_sha1_finish(&ctx, mac);
+      mbedtls_sha1_free(&ctx);
+      return ok ? SHA1_SIZE : 0;
+    }
+    case AUTH_AES_CMAC:
+      if (mbedtls_cipher_cmac_reset(&key.cmac)
+       || mbedtls_cipher_cmac_update(&key.cmac, data, size)
+       || mbedtls_cipher_cmac_finish(&key.cmac, mac)) return 0;
+      return CMAC_SIZE;
+  }
+  return 0;
+}
+
+bool Keyring::sign(NTP& ntp) {
+  Key* const key = find(ntp.getKeyId());
+  if (!key) return false;
+
+  uint8_t mac[NTP_MAX_MAC];
+  const byte len = digest(*key, ntp, mac);
+  if (!len) return false;
+  ntp.setMac(mac, len);
+  return true;
+}
+
+bool Keyring::verify(const NTP& ntp) {
+  Key* const key = find(ntp.getKeyId());
+  if (!key) return false;
+
+  uint8_t mac[NTP_MAX_MAC];
+  const byte len = digest(*key, ntp, mac);
+  if (!len || (len != ntp.getMacLength())) return false;
+
+  uint8_t diff = 0;  // comparaison en temps constant.
+  for (byte i = 0; i < len; ++i) diff |= mac[i] ^ ntp.getMac()[i];
+  return !diff;
+}
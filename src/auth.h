@@ -0,0 +1,87 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <mbedtls/sha1.h>
+#include <mbedtls/cipher.h>
+#include "ntp.h"
+#include "transport.h"
+
+/**
+ * Nombre maximal de clés symétriques.
+ */
+#define MAX_KEYS 4
+
+/**
+ * Algorithmes de MAC.
+ *  AUTH_SHA1 : SHA-1(clé || paquet), 20 octets, compatible ntpd (type "SHA1" du fichier ntp.keys).
+ *  AUTH_AES_CMAC : AES-128-CMAC(paquet), 16 octets (RFC 8573).
+ */
+enum AuthType { AUTH_SHA1, AUTH_AES_CMAC };
+
+/**
+ * Trousseau de clés symétriques pour l'authentification des paquets NTP (Key ID + MAC, RFC 5905 §7.3).
+ *
+ * La préparation de chaque clé est faite une fois à l'ajout : état SHA-1 après absorption de la clé, ou
+ * ordonnancement de clé AES et sous-clés CMAC. Signer ou vérifier un paquet repart de cet état.
+ */
+class Keyring : public PacketSigner {
+  public:
+/**
+ * Public constructor ; trousseau vide.
+ */
+    Keyring();
+    ~Keyring();
+
+/**
+ * Ajoute une clé.
+ * @param id Identifiant de la clé (non nul).
+ * @param type Algorithme.
+ * @param key La clé.
+ * @param len Sa taille (16 octets pour AES-128-CMAC).
+ * @return Faux si le trousseau est plein ou la clé invalide.
+ */
+    bool add(const uint32_t id, const AuthType type, const uint8_t key[], const size_t len);
+
+/**
+ * Calcule et ajoute le MAC d'un paquet, avec la clé désignée par son Key ID.
+ * @param ntp Paquet portant un Key ID (NTP::setKeyId), entièrement renseigné.
+ * @return Faux si la clé est inconnue.
+ */
+    bool sign(NTP& ntp) override;
+
+/**
+ * Vérifie le MAC d'un paquet reçu.
+ * @param ntp Paquet reçu.
+ * @return Vrai si le Key ID est connu et le MAC correct.
+ */
+    bool verify(const NTP& ntp);
+
+  private:
+    struct Key {
+      uint32_t id;
+      AuthType type;
+      mbedtls_sha1_context sha1;      // état après absorption de la clé.
+      mbedtls_cipher_context_t cmac;  // clé AES étendue et sous-clés CMAC.
+    };
+
+    Key* find(const uint32_t id);
+    byte digest(Key& key, const NTP& ntp, uint8_t mac[NTP_MAX_MAC]);
+
+    Key  keys[MAX_KEYS];
+    byte count;
+};
@@ -0,0 +1,45 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "broadcast.h"
+
+BroadcastClient::BroadcastClient() :
+  server(),
+  delay(0),
+  origin(0),
+  calibrated(false)
+{}
+
+bool BroadcastClient::accept(const NTP& packet, const Endpoint& from) {
+  if (packet.getMode() != NTPMODE_BROADCAST || !packet.getT2()) return false;
+  if (!packet.getStratum() || packet.getStratum() >= MAXSTRAT) return false;
+
+  if (!server.ip) server = from;
+  return from.ip == server.ip;
+}
+
+bool BroadcastClient::calibrate(const NTP& reply, const Endpoint& from) {
+  if (!origin || (from.ip != server.ip) || (reply.getT0() != origin)) return false;
+  origin = 0;   // une seule réponse par requête.
+  if (reply.check() != NTP_CHECK_OK) return false;
+  delay = reply.getRTT() / 2;
+  calibrated = true;
+  return true;
+}
+
+int64_t BroadcastClient::getOffset(const NTP& packet) const {
+  return int64_t(packet.getT2() + delay) - int64_t(packet.getT3());
+}
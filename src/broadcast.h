@@ -0,0 +1,87 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "transport.h"
+
+/**
+ * Client du mode diffusion (broadcast/multicast).
+ *
+ * Le premier serveur entendu est retenu ; le délai aller simple est calibré une fois par un échange unicast
+ * client/serveur (RTT / 2), puis chaque paquet diffusé donne un offset sans aucune requête. L'échange de
+ * calibration est une association à part : sa requête et sa réponse ne touchent pas celles du serveur amont.
+ */
+class BroadcastClient {
+  public:
+/**
+ * Public constructor.
+ */
+    BroadcastClient();
+
+/**
+ * Filtre un paquet reçu.
+ * @param packet Paquet reçu (T3 = heure de réception).
+ * @param from Adresse de l'émetteur.
+ * @return Vrai si c'est un paquet diffusé valide du serveur retenu.
+ */
+    bool accept(const NTP& packet, const Endpoint& from);
+
+/**
+ * Mémorise la requête de calibration envoyée au serveur retenu.
+ * @param request Requête estampillée (champ Transmit) par le transport.
+ */
+    void sent(const NTP& request) { origin = request.getT2(); }
+
+/**
+ * Enregistre le délai mesuré par l'échange unicast avec le serveur retenu.
+ * @param reply Réponse reçue (T3 = heure de réception).
+ * @param from Adresse de l'émetteur.
+ * @return Faux si ce n'est pas une réponse valide du serveur retenu à la dernière requête.
+ */
+    bool calibrate(const NTP& reply, const Endpoint& from);
+
+/**
+ * Calcule l'offset à partir d'un paquet diffusé : T2 + délai - T3.
+ * @param packet Paquet accepté.
+ * @return Ecart signé en microsecondes.
+ */
+    int64_t getOffset(const NTP& packet) const;
+
+/**
+ * Indique si le délai a été calibré.
+ * @return Vrai après calibrate().
+ */
+    bool isCalibrated() const { return calibrated; }
+
+/**
+ * Retourne le serveur retenu.
+ * @return Son adresse (ip à 0 tant qu'aucun paquet n'a été entendu).
+ */
+    const Endpoint& getServer() const { return server; }
+
+/**
+ * Retourne le délai aller simple calibré.
+ * @return Un temps en microsecondes.
+ */
+    unsigned long getDelay() const { return delay; }
+
+  private:
+    Endpoint server;
+    unsigned long delay;  // [µs]
+    uint64_t origin;      // Transmit de la requête de calibration en cours, 0 sinon.
+    bool calibrated;
+};
@@ -0,0 +1,150 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "control.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define MODE_CONTROL 6
+#define HEADER 12
+#define DATA (CONTROL_SIZE - HEADER)
+
+#define OP_READSTAT 1
+#define OP_READVAR 2
+
+#define BIT_RESPONSE 0x80
+#define BIT_ERROR 0x40
+
+#define ERR_BADOP 5
+#define ERR_BADASSOC 7
+
+#define SRC_NTP 6        // Source de l'horloge système : NTP.
+#define PST_CONFIG 0x80  // Association configurée.
+#define PST_REACH 0x10   // Association joignable.
+#define SEL_CANDIDATE 4
+#define SEL_SYSPEER 6
+
+/**
+ * Ecrit un entier 16 bits en ordre réseau.
+ */
+static void put16(uint8_t p[], const uint16_t v) {
+  p[0] = v >> 8;
+  p[1] = v & 0xFF;
+}
+
+static uint16_t get16(const uint8_t p[]) {
+  return (p[0] << 8) | p[1];
+}
+
+ControlResponder::ControlResponder() :
+  snapshot(),
+  sequence(0)
+{}
+
+void ControlResponder::publish(const SyncSnapshot& aSnapshot) {
+  sequence.fetch_add(1, std::memory_order_acquire);
+  snapshot = aSnapshot;
+  sequence.fetch_add(1, std::memory_order_release);
+}
+
+size_t ControlResponder::respond(const uint8_t request[], const size_t len, uint8_t reply[CONTROL_SIZE]) const {
+  if ((len < HEADER) || ((request[0] & 0b0111) != MODE_CONTROL) || (request[1] & BIT_RESPONSE)) return 0;
+
+  SyncSnapshot s;
+  uint32_t seq;
+  do {
+    seq = sequence.load(std::memory_order_acquire);
+    s = snapshot;
+    std::atomic_thread_fence(std::memory_order_acquire);
+  } while ((seq & 1) || (seq != sequence.load(std::memory_order_relaxed)));
+  const uint8_t opcode = request[1] & 0b00011111;
+  const uint16_t assoc = get16(request + 6);
+
+  uint16_t status = 0;
+  size_t count;
+  switch (opcode) {
+    case OP_READSTAT:
+      count = readStatus(s, assoc, reply + HEADER, status);
+      break;
+    case OP_READVAR:
+      count = readVariables(s, assoc, reply + HEADER, status);
+      break;
+    default:
+      count = 0;
+      status = ERR_BADOP << 8;
+      break;
+  }
+
+  reply[0] = (request[0] & 0b00111000) | MODE_CONTROL;  // LI 0, version de la requête.
+  reply[1] = BIT_RESPONSE | opcode;
+  if (count == size_t(-1)) {
+    reply[1] |= BIT_ERROR;
+    status = ERR_BADASSOC << 8;
+    count = 0;
+  }
+  memcpy(reply + 2, request + 2, 2);  // sequence.
+  put16(reply + 4, status);
+  put16(reply + 6, assoc);
+  put16(reply + 8, 0);                // offset : une seule réponse.
+  put16(reply + 10, count);
+
+  size_t size = HEADER + count;
+  while (size % 4) reply[size++] = 0; // alignement sur 32 bits.
+  return size;
+}
+
+size_t ControlResponder::readStatus(const SyncSnapshot& s, const uint16_t assoc, uint8_t data[], uint16_t& status) const {
+  if (assoc) {
+    if (assoc > s.assocs) return size_t(-1);
+    status = (PST_CONFIG | PST_REACH | (s.assoc[assoc - 1].selected ? SEL_SYSPEER : SEL_CANDIDATE)) << 8;
+    return 0;
+  }
+
+  status = (s.leap << 14) | (SRC_NTP << 8);
+  size_t count = 0;
+  for (uint8_t i = 0; i < s.assocs; ++i) {
+    put16(data + count, i + 1);
+    put16(data + count + 2, (PST_CONFIG | PST_REACH | (s.assoc[i].selected ? SEL_SYSPEER : SEL_CANDIDATE)) << 8);
+    count += 4;
+  }
+  return count;
+}
+
+size_t ControlResponder::readVariables(const SyncSnapshot& s, const uint16_t assoc, uint8_t data[], uint16_t& status) const {
+  char* const text = (char*)data;
+  int n;
+  if (assoc) {
+    if (assoc > s.assocs) return size_t(-1);
+    const auto& a = s.assoc[assoc - 1];
+    status = (PST_CONFIG | PST_REACH | (a.selected ? SEL_SYSPEER : SEL_CANDIDATE)) << 8;
+    n = snprintf(text, DATA,
+      "srcadr=%u.%u.%u.%u, srcport=123, stratum=%u, hpoll=%u, ppoll=%u, offset=%.3f, delay=%.3f, jitter=%.3f\r\n",
+      uint8_t(a.address[0]), uint8_t(a.address[1]), uint8_t(a.address[2]), uint8_t(a.address[3]),
+      a.stratum, a.hpoll, a.ppoll, a.offset, a.delay, a.jitter);
+  } else {
+    status = (s.leap << 14) | (SRC_NTP << 8);
+    n = snprintf(text, DATA,
+      "version=\"ESP32 NTP Timer v0\", processor=\"esp32\", leap=%u, stratum=%u, precision=%d, "
+      "rootdelay=%.3f, rootdisp=%.3f, refid=%u.%u.%u.%u, reftime=0x%08lx.%08lx, tc=%u, "
+      "offset=%.3f, frequency=%.3f, sys_jitter=%.3f, clk_wander=%.3f, adev=%.3e\r\n",
+      s.leap, s.stratum, s.precision, s.rootDelay, s.rootDisp,
+      uint8_t(s.refId[0]), uint8_t(s.refId[1]), uint8_t(s.refId[2]), uint8_t(s.refId[3]),
+      (unsigned long)(s.refTime / 1000000), (unsigned long)(((s.refTime % 1000000) << 32) / 1000000),
+      s.poll, s.offset, s.frequency, s.jitter, s.adev * 1e6, s.adev);
+  }
+  return (n < 0) ? 0 : (n >= DATA ? DATA - 1 : n);
+}
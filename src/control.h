@@ -0,0 +1,97 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Nombre maximal d'associations publiées.
+ */
+#define CONTROL_ASSOCS 10
+
+/**
+ * Taille maximale d'un message de contrôle (entête 12 octets + 468 octets de données).
+ */
+#define CONTROL_SIZE 480
+
+/**
+ * Etat de la synchronisation publié pour le mode 6 (copie, jamais lue par le moteur de synchronisation).
+ */
+struct SyncSnapshot {
+  uint8_t  leap;
+  uint8_t  stratum;
+  int8_t   precision;
+  uint8_t  poll;            // exposant.
+  char     refId[4];
+  uint64_t refTime;         // [µs] depuis 1900.
+  double   offset;          // [ms]
+  double   jitter;          // [ms]
+  double   frequency;       // [ppm]
+  double   adev;            // [s/s]
+  double   rootDelay;       // [ms]
+  double   rootDisp;        // [ms]
+  uint8_t  assocs;          // nombre d'associations valides.
+  struct {
+    char     address[4];    // IPv4 (ordre réseau).
+    uint8_t  stratum;
+    uint8_t  hpoll;         // exposant de notre intervalle d'interrogation de cette source.
+    uint8_t  ppoll;         // exposant annoncé par la source dans son dernier paquet.
+    bool     selected;      // source courante (sys.peer).
+    double   offset;        // [ms]
+    double   delay;         // [ms]
+    double   jitter;        // [ms]
+  } assoc[CONTROL_ASSOCS];
+};
+
+/**
+ * Répondeur des messages de contrôle NTP (mode 6) : READSTAT et READVAR, compatibles ntpq.
+ *
+ * Le moteur de synchronisation publie un instantané après chaque mise à jour ; les réponses sont construites
+ * à partir d'une copie du dernier instantané publié (seqlock) : la publication ne bloque jamais.
+ * @see https://www.rfc-editor.org/rfc/rfc9327
+ */
+class ControlResponder {
+  public:
+/**
+ * Public constructor.
+ */
+    ControlResponder();
+
+/**
+ * Publie un nouvel état.
+ * @param snapshot Etat courant de la synchronisation.
+ */
+    void publish(const SyncSnapshot& snapshot);
+
+/**
+ * Construit la réponse à une requête de contrôle.
+ * @param request Requête reçue.
+ * @param len Taille de la requête.
+ * @param reply Tampon recevant la réponse (CONTROL_SIZE octets).
+ * @return La taille de la réponse, 0 si la requête est ignorée.
+ */
+    size_t respond(const uint8_t request[], const size_t len, uint8_t reply[CONTROL_SIZE]) const;
+
+  private:
+    size_t readStatus(const SyncSnapshot& s, const uint16_t assoc, uint8_t data[], uint16_t& status) const;
+    size_t readVariables(const SyncSnapshot& s, const uint16_t assoc, uint8_t data[], uint16_t& status) const;
+
+    SyncSnapshot snapshot;
+    std::atomic<uint32_t> sequence;   // impair pendant une publication.
+};
@@ -0,0 +1,255 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+
+#include "cron.h"
+
+#include <cctype>
+
+static const char MONTHS[] = "JANFEBMARAPRMAYJUNJULAUGSEPOCTNOVDEC";
+static const char WEEKDAYS[] = "SUNMONTUEWEDTHUFRISAT";
+
+/**
+ * Premier bit à 1 à partir du bit from, -1 s'il n'y en a pas.
+ */
+static int nextBit(const uint64_t bits, const int from) {
+  if (from >= 64) return -1;
+  const uint64_t rest = bits >> from;
+  return rest ? from + __builtin_ctzll(rest) : -1;
+}
+
+/**
+ * Nombre de jours depuis le 1er janvier 1970 d'une date du calendrier grégorien (H. Hinnant).
+ */
+static long toDays(int year, const int month, const int day) {
+  year -= month <= 2;
+  const long era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yoe = unsigned(year - era * 400);
+  const unsigned doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + long(doe) - 719468;
+}
+
+/**
+ * Date du calendrier grégorien d'un nombre de jours depuis le 1er janvier 1970.
+ */
+static void toDate(long days, int& year, int& month, int& day) {
+  days += 719468;
+  const long era = (days >= 0 ? days : days - 146096) / 146097;
+  const unsigned doe = unsigned(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp = (5 * doy + 2) / 153;
+  day = doy - (153 * mp + 2) / 5 + 1;
+  month = mp < 10 ? mp + 3 : mp - 9;
+  year = int(yoe) + era * 400 + (month <= 2);
+}
+
+static int monthDays(const int year, const int month) {
+  static const uint8_t DAYS[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  const bool leap = !(year % 4) && ((year % 100) || !(year % 400));
+  return DAYS[month - 1] + ((month == 2) && leap);
+}
+
+CronExpression::CronExpression() :
+  minutes(0),
+  hours(0),
+  days(0),
+  months(0),
+  weekdays(0),
+  anyDay(true),
+  anyWeekday(true)
+{}
+
+bool CronExpression::compile(const char expression[]) {
+  uint64_t fields[5];
+  static const struct { int min; int max; const char* names; } RANGES[] = {
+    { 0, 59, nullptr }, { 0, 23, nullptr }, { 1, 31, nullptr }, { 1, 12, MONTHS }, { 0, 7, WEEKDAYS }
+  };
+  bool any[5];
+
+  *this = CronExpression();
+  const char* p = expression;
+  for (int i = 0; i < 5; ++i) {
+    while (*p == ' ') ++p;
+    any[i] = *p == '*';
+    p = parseField(p, RANGES[i].min, RANGES[i].max, RANGES[i].names, fields[i]);
+    if (!p || ((*p != ' ') && *p && (i < 4)) || !fields[i]) return false;
+  }
+  while (*p == ' ') ++p;
+  if (*p) return false;
+
+  minutes = fields[0];
+  hours = fields[1];
+  days = fields[2];
+  months = fields[3];
+  weekdays = (fields[4] | (fields[4] >> 7)) & 0x7F;   // 7 = dimanche.
+  anyDay = any[2];
+  anyWeekday = any[4];
+  return true;
+}
+
+const char* CronExpression::parseField(const char* p, const int min, const int max, const char* names, uint64_t& bits) {
+  bits = 0;
+  while (true) {
+    int first = min;
+    int last = max;
+    if (*p == '*') {
+      ++p;
+    } else {
+      p = parseValue(p, min, names, first);
+      if (!p) return nullptr;
+      last = first;
+      if (*p == '-') {
+        p = parseValue(p + 1, min, names, last);
+        if (!p) return nullptr;
+      } else if (*p == '/') {
+        last = max;   // a/n : de a à la fin.
+      }
+    }
+    int step = 1;
+    if (*p == '/') {
+      p = parseValue(p + 1, 1, nullptr, step);
+      if (!p || (step < 1)) return nullptr;
+    }
+    if ((first < min) || (last > max) || (first > last)) return nullptr;
+    for (int v = first; v <= last; v += step) bits |= uint64_t(1) << v;
+
+    if (*p != ',') return p;
+    ++p;
+  }
+}
+
+const char* CronExpression::parseValue(const char* p, const int min, const char* names, int& value) {
+  if (isdigit((unsigned char)*p)) {
+    value = 0;
+    while (isdigit((unsigned char)*p)) {
+      value = value * 10 + (*p++ - '0');
+      if (value > 1000) return nullptr;
+    }
+    return p;
+  }
+  if (!names) return nullptr;
+  for (int i = 0; names[3 * i]; ++i) {
+    const char* const name = names + 3 * i;
+    if ((toupper((unsigned char)p[0]) == name[0]) && (toupper((unsigned char)p[1]) == name[1]) && (toupper((unsigned char)p[2]) == name[2])) {
+      value = min + i;
+      return p + 3;
+    }
+  }
+  return nullptr;
+}
+
+int CronExpression::nextDay(const int year, const int month, const int day) const {
+  const int count = monthDays(year, month);
+  if (day > count) return 0;
+
+  int byDay = nextBit(days & ((uint64_t(2) << count) - 1), day);
+  const int weekday = (toDays(year, month, day) + 4) % 7;   // le 1er janvier 1970 était un jeudi.
+  const int shift = nextBit(weekdays | (uint64_t(weekdays) << 7), weekday);
+  int byWeekday = shift < 0 ? -1 : day + shift - weekday;
+  if (byWeekday > count) byWeekday = -1;
+
+  if (anyDay && anyWeekday) return day;
+  if (anyWeekday) byWeekday = -1;   // seul le jour du mois est restreint.
+  else if (anyDay) byDay = -1;      // seul le jour de la semaine est restreint.
+  if (byDay < 0) return byWeekday < 0 ? 0 : byWeekday;
+  if (byWeekday < 0) return byDay;
+  return byDay < byWeekday ? byDay : byWeekday;
+}
+
+time_t CronExpression::nextLocal(const time_t local) const {
+  if (!minutes) return 0;   // expression vide.
+
+  const time_t start = local / 60 * 60 + 60;
+  int year, month, day;
+  toDate(start / 86400, year, month, day);
+  int hour = start % 86400 / 3600;
+  int minute = start % 3600 / 60;
+  const int last = year + CRON_YEARS;
+
+  while (year <= last) {
+    if (!((months >> month) & 1)) {   // mois suivant de l'ensemble.
+      const int next = nextBit(months, month + 1);
+      if (next < 0) {
+        ++year;
+        month = nextBit(months, 1);
+      } else {
+        month = next;
+      }
+      day = 1;
+      hour = 0;
+      minute = 0;
+      continue;
+    }
+    const int next = nextDay(year, month, day);
+    if (!next) {
+      if (++month > 12) {
+        month = 1;
+        ++year;
+      }
+      day = 1;
+      hour = 0;
+      minute = 0;
+      continue;
+    }
+    if (next != day) {
+      day = next;
+      hour = 0;
+      minute = 0;
+    }
+    const int h = nextBit(hours, hour);
+    if (h < 0) {
+      ++day;
+      hour = 0;
+      minute = 0;
+      continue;
+    }
+    if (h != hour) {
+      hour = h;
+      minute = 0;
+    }
+    const int m = nextBit(minutes, minute);
+    if (m < 0) {
+      ++hour;
+      minute = 0;
+      continue;
+    }
+    return time_t(toDays(year, month, day)) * 86400 + hour * 3600 + m * 60;
+  }
+  return 0;
+}
+
+time_t CronExpression::nextFire(const time_t after, const Timezone& timezone) const {
+  const bool everyHour = hours == 0xFFFFFF;
+  time_t from = after;    // occurrences strictement après from [UTC].
+  time_t seen = 0;        // heures locales déjà passées (recouvrement).
+
+  for (int i = 0; i < 2 * CRON_YEARS + 2; ++i) {   // au plus deux changements d'heure par an.
+    const time_t offset = timezone.localtime(from + 1) - (from + 1);
+    const time_t change = timezone.nextChange(from + 1);  // dernière seconde avec ce décalage.
+    const time_t local = nextLocal(from + offset > seen ? from + offset : seen);
+    if (!local) return 0;
+    if (!change || (local - offset <= change)) return local - offset;
+
+    const time_t next = timezone.localtime(change + 1) - (change + 1);
+    if ((next > offset) && (local <= change + next)) return change;  // trou : l'heure sautée a lieu au changement.
+    if ((next < offset) && !everyHour) seen = change + offset;       // recouvrement : déjà passé une fois.
+    from = change;
+  }
+  return 0;
+}
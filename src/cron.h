@@ -0,0 +1,99 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include "timezone.h"
+
+#define CRON_YEARS 8    // Horizon de recherche : une expression sans occurrence dans CRON_YEARS ans n'en a pas [ans].
+
+/**
+ * Expression cron à cinq champs, "minute heure jour mois jour-de-la-semaine", compilée en ensembles de bits.
+ * Chaque champ accepte *, des valeurs, des intervalles a-b, des pas (a-b/n, ou * suivi de /n) et des listes
+ * séparées par des virgules ; les mois et les jours de la semaine acceptent aussi leurs noms anglais (JAN,
+ * MON...), dimanche valant 0 ou 7. Comme pour cron, si le jour du mois et le jour de la semaine sont tous deux
+ * restreints, l'un OU l'autre suffit.
+ *
+ * Exemple : "30 7 * * MON-FRI" pour 07:30 heure locale, les jours ouvrés.
+ */
+class CronExpression {
+  public:
+/**
+ * Public constructor : expression vide, sans aucune occurrence.
+ */
+    CronExpression();
+
+/**
+ * Compile une expression.
+ * @param expression Les cinq champs séparés par des espaces.
+ * @return Faux si l'expression est invalide (l'expression est alors vide).
+ */
+    bool compile(const char expression[]);
+
+/**
+ * Retourne la prochaine occurrence en heure locale, en avançant champ par champ : un mois exclu est sauté
+ * d'un coup, de même qu'un jour ou une heure, sans parcourir les minutes une à une.
+ * @param local Heure locale (temps unix décalé) [s].
+ * @return La première minute correspondante strictement après local, 0 s'il n'y en a pas dans CRON_YEARS ans.
+ */
+    time_t nextLocal(const time_t local) const;
+
+/**
+ * Retourne la prochaine occurrence en UTC pour un fuseau horaire. Une heure locale sautée au printemps a lieu
+ * au changement d'heure (une seule fois, même si plusieurs minutes sont sautées). Une heure locale répétée en
+ * automne a lieu une seule fois, à sa première occurrence, sauf si le champ des heures est * : l'expression
+ * suit alors le temps écoulé et a aussi lieu pendant la seconde occurrence.
+ * @param after Heure UTC [s].
+ * @param timezone Fuseau horaire des champs de l'expression.
+ * @return La première occurrence strictement après after, 0 s'il n'y en a pas.
+ */
+    time_t nextFire(const time_t after, const Timezone& timezone) const;
+
+  private:
+/**
+ * Compile un champ dans un ensemble de bits.
+ * @param field Début du champ, terminé par un espace ou la fin de la chaîne.
+ * @param min Plus petite valeur.
+ * @param max Plus grande valeur.
+ * @param names Noms des valeurs depuis min (3 lettres chacun), nullptr si aucun.
+ * @param bits Reçoit l'ensemble.
+ * @return Fin du champ, nullptr s'il est invalide.
+ */
+    static const char* parseField(const char* field, const int min, const int max, const char* names, uint64_t& bits);
+
+/**
+ * Lit une valeur numérique ou un nom.
+ * @return Fin de la valeur, nullptr si invalide.
+ */
+    static const char* parseValue(const char* p, const int min, const char* names, int& value);
+
+/**
+ * Retourne le premier jour correspondant à partir du jour day, 0 s'il n'y en a plus dans le mois.
+ */
+    int nextDay(const int year, const int month, const int day) const;
+
+    uint64_t minutes;   // Bits 0 à 59.
+    uint32_t hours;     // Bits 0 à 23.
+    uint32_t days;      // Bits 1 à 31.
+    uint16_t months;    // Bits 1 à 12.
+    uint8_t  weekdays;  // Bits 0 (dimanche) à 6.
+    bool     anyDay;    // Jour du mois non restreint (*).
+    bool     anyWeekday;  // Jour de la semaine non restreint (*).
+};
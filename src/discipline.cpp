@@ -0,0 +1,137 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "discipline.h"
+
+#include <cmath>
+
+#define AVG    4      // Constante de temps des moyennes glissantes (en nombre de mesures).
+#define PGATE  4      // Seuil de bruit : |offset| < PGATE x jitter.
+#define LIMIT  30     // Seuil d'hystérésis du compteur de polling.
+#define GAIN   0.05   // Gain de la correction de phase par seconde de polling.
+
+Discipline::Discipline() :
+  pollExp(MINPOLL),
+  pollFloor(MINPOLL),
+  pollCount(0),
+  samples(0),
+  jitter(0),
+  adev(0),
+  avar(0),
+  lastOffset(0),
+  lastPhase(0),
+  corrections(0),
+  lastFreq(0),
+  frequency(0),
+  lastEpoch(0),
+  restored(false),
+  predicted(false),
+  prediction(0),
+  tickEpoch(0),
+  tickResidue(0),
+  tickApplied(0),
+  lastResidual(0),
+  rootDelay(0),
+  rootDisp(0),
+  rootEpoch(0)
+{}
+
+long Discipline::update(const int64_t offset, const unsigned long epoch, const bool accept) {
+  const int64_t phase = offset + corrections;
+
+  if (samples > 0) {
+    const double diff = double(offset - lastOffset);
+    jitter = sqrt(jitter * jitter + (diff * diff - jitter * jitter) / AVG);
+
+    const auto tau = epoch - lastEpoch;
+    if (tau > 0) {
+      const double freq = double(phase - lastPhase) / tau;  // µs/s = ppm
+      const double residual = freq - double(tickApplied) / tau;  // ce que tick() n'a pas déjà compensé.
+      if (samples > 1) {
+        const double d = residual - lastResidual;
+        avar += ((d * d) / 2 - avar) / (samples > AVG ? AVG : samples - 1);
+        adev = sqrt(avar) * 1e-6;
+      }
+      frequency += (freq - frequency) / (samples > AVG ? AVG : samples + (restored ? 1 : 0));
+      lastFreq = freq;
+      lastResidual = residual;
+    }
+  }
+  tickApplied = 0;
+  ++samples;
+  lastOffset = offset;
+  lastPhase = phase;
+  lastEpoch = epoch;
+
+// Adaptation du polling : grandit dans le bruit, diminue sur un pic de jitter.
+  const double wander = adev * (1UL << (pollExp + 1)) * 1e6;  // dérive prévue au prochain polling [µs]
+  if ((samples > 2) && (fabs(double(offset)) < PGATE * jitter) && (wander < PGATE * jitter)) {
+    pollCount += pollExp;
+    if (pollCount > LIMIT) {
+      pollCount = 0;
+      if (pollExp < MAXPOLL) ++pollExp;
+    }
+  } else if (samples > 2) {
+    pollCount -= 2 * pollExp;
+    if (pollCount < -LIMIT) {
+      pollCount = 0;
+      if (pollExp > pollFloor) --pollExp;
+    }
+  }
+
+  if (!accept) return 0;
+
+  const double gain = GAIN * getPoll();
+  const long correction = offset * (gain > 1 ? 1 : gain);
+  corrections += correction;
+  return correction;
+}
+
+void Discipline::backoff(const unsigned minimum) {
+  uint8_t exp = pollFloor;
+  while ((exp < MAXPOLL) && ((1U << exp) < minimum)) ++exp;
+  pollFloor = exp;
+  if (pollExp < MAXPOLL) ++pollExp;
+  if (pollExp < pollFloor) pollExp = pollFloor;
+  pollCount = 0;
+}
+
+long Discipline::tick(const unsigned long epoch) {
+  double rate;
+  if (predicted) rate = prediction;
+  else if (restored || (samples > 2)) rate = frequency;  // apprise, ou reprise au démarrage à chaud.
+  else return 0;
+
+  if (tickEpoch < lastEpoch) tickEpoch = lastEpoch;   // rien d'appliqué depuis la dernière mesure.
+  if (!tickEpoch) tickEpoch = epoch;                   // premier appel avant toute mesure.
+  if (epoch <= tickEpoch) return 0;
+
+  tickResidue += rate * (epoch - tickEpoch);          // ppm x s = µs
+  tickEpoch = epoch;
+  const long correction = long(tickResidue);
+  tickResidue -= correction;
+  corrections += correction;          // la phase libre reste juste quand les mesures reprennent.
+  tickApplied += correction;
+  return correction;
+}
+
+void Discipline::setRoot(const uint32_t upstreamDelay, const uint32_t upstreamDisp, const unsigned long rtt, const uint32_t precision, const unsigned long epoch) {
+  const uint64_t delay = uint64_t(upstreamDelay) + rtt;
+  const uint64_t disp = uint64_t(upstreamDisp) + precision + uint64_t(rtt) * PHI / 1000000 + uint64_t(jitter);
+  rootDelay = delay > UINT32_MAX ? UINT32_MAX : uint32_t(delay);
+  rootDisp = disp > UINT32_MAX ? UINT32_MAX : uint32_t(disp);
+  rootEpoch = epoch;
+}
@@ -0,0 +1,205 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+#include "ntp.h"
+
+/**
+ * Bornes de l'exposant de polling (2^n secondes), comme dans la RFC 5905.
+ */
+#define MINPOLL 4   // 16 s
+#define MAXPOLL 10  // 1024 s
+
+/**
+ * Discipline de l'horloge locale : applique les corrections de phase et adapte l'intervalle de polling.
+ *
+ * L'exposant de polling augmente tant que les offsets restent dans le bruit (jitter) et que la dérive
+ * prévue de l'oscillateur local (ADEV x tau) ne le dépasse pas ; il diminue dès qu'un pic de jitter apparaît.
+ * @see https://www.rfc-editor.org/rfc/rfc5905#appendix-A.5.5.7
+ */
+class Discipline {
+  public:
+/**
+ * Public constructor.
+ */
+    Discipline();
+
+/**
+ * Prend en compte une nouvelle mesure d'offset et calcule la correction à appliquer.
+ * @param offset Ecart mesuré en microsecondes.
+ * @param epoch Heure UTC de la mesure [s].
+ * @param accept Faux si la mesure n'est pas assez fiable pour corriger l'horloge.
+ * @return La correction de phase à appliquer en microsecondes.
+ */
+    long update(const int64_t offset, const unsigned long epoch, const bool accept = true);
+
+/**
+ * Retourne le dernier offset mesuré.
+ * @return Ecart signé en microsecondes.
+ */
+    int64_t getOffset() const { return lastOffset; }
+
+/**
+ * Retourne le jitter (moyenne quadratique des écarts entre offsets successifs).
+ * @return Le jitter en microsecondes.
+ */
+    double getJitter() const { return jitter; }
+
+/**
+ * Retourne l'écart-type d'Allan estimé de l'oscillateur local, à l'intervalle de polling courant.
+ * @return Une valeur sans unité (s/s), 0 tant qu'il n'y a pas assez de mesures.
+ */
+    double getAdev() const { return adev; }
+
+/**
+ * Retourne l'écart de fréquence estimé de l'oscillateur local (moyenne glissante).
+ * @return Une valeur en ppm, positive si l'horloge locale retarde.
+ */
+    double getFrequency() const { return frequency; }
+
+/**
+ * Retourne l'exposant de polling courant.
+ * @return Un exposant entre MINPOLL et MAXPOLL.
+ */
+    uint8_t getPollExponent() const { return pollExp; }
+
+/**
+ * Retourne l'intervalle de polling courant.
+ * @return Un temps en secondes.
+ */
+    unsigned getPoll() const { return 1U << pollExp; }
+
+/**
+ * Ralentit le polling à la demande du serveur (Kiss-o'-Death RATE) ; l'intervalle ne redescend plus sous ce minimum.
+ * @param minimum Intervalle minimal demandé par le serveur [s].
+ */
+    void backoff(const unsigned minimum);
+
+/**
+ * Retourne la somme des corrections de phase appliquées depuis le démarrage (mesures et tick()) ; la différence
+ * entre deux lectures donne ce qui a été appliqué à l'horloge locale entre deux instants.
+ * @return Un temps en microsecondes.
+ */
+    int64_t getCorrections() const { return corrections; }
+
+/**
+ * Indique si une fréquence a déjà été mesurée (deux mesures au moins).
+ */
+    bool hasFrequency() const { return samples > 1; }
+
+/**
+ * Retourne la fréquence de l'oscillateur mesurée sur le dernier intervalle (non lissée).
+ * @return Une valeur en ppm, positive si l'horloge locale retarde.
+ */
+    double getLastFrequency() const { return lastFreq; }
+
+/**
+ * Démarrage à chaud : reprend la fréquence conservée du démarrage précédent, appliquée par tick() dès
+ * la première seconde puis affinée par les mesures.
+ * @param ppm Fréquence de l'oscillateur [ppm].
+ */
+    void restore(const double ppm) { frequency = ppm; restored = true; }
+
+/**
+ * Signale un saut de l'horloge locale (première synchronisation) : tick() repart de cette heure.
+ * @param epoch Nouvelle heure UTC [s].
+ */
+    void resync(const unsigned long epoch) { tickEpoch = epoch; tickResidue = 0; }
+
+/**
+ * Fréquence prédite de l'oscillateur (modèle thermique), appliquée en avance de phase par tick().
+ * @param valid Faux s'il n'y a pas de prédiction.
+ * @param ppm Fréquence prédite [ppm].
+ */
+    void setPrediction(const bool valid, const double ppm) { predicted = valid; prediction = ppm; }
+
+/**
+ * A appeler chaque seconde : applique en avance la fréquence prédite (modèle thermique), ou à défaut la
+ * fréquence apprise (ou reprise au démarrage), pour que l'horloge locale suive entre deux mesures et en
+ * holdover au lieu de dériver ; la boucle de phase ne corrige plus que le résidu.
+ * @param epoch Heure UTC courante [s].
+ * @return La correction de phase à appliquer depuis l'appel précédent (ou la dernière mesure) [µs].
+ */
+    long tick(const unsigned long epoch);
+
+/**
+ * Mémorise la distance à la référence primaire après une mesure acceptée (RFC 5905 §11.2).
+ * @param upstreamDelay Délai racine annoncé par la source [µs].
+ * @param upstreamDisp Dispersion racine annoncée par la source [µs].
+ * @param rtt Délai aller/retour mesuré jusqu'à la source [µs].
+ * @param precision Précision de la source plus celle de l'horloge locale [µs].
+ * @param epoch Heure UTC de la mesure [s].
+ */
+    void setRoot(const uint32_t upstreamDelay, const uint32_t upstreamDisp, const unsigned long rtt, const uint32_t precision, const unsigned long epoch);
+
+/**
+ * Retourne le délai aller/retour jusqu'à la référence primaire.
+ * @return Un temps en microsecondes.
+ */
+    uint32_t getRootDelay() const { return rootDelay; }
+
+/**
+ * Retourne la dispersion jusqu'à la référence primaire, qui croît de PHI depuis la dernière mesure.
+ * @param epoch Heure UTC courante [s].
+ * @return Un temps en microsecondes.
+ */
+    uint32_t getRootDispersion(const unsigned long epoch) const {
+      const uint64_t d = rootDisp + uint64_t(epoch - rootEpoch) * PHI;
+      return d > UINT32_MAX ? UINT32_MAX : uint32_t(d);
+    }
+
+/**
+ * Retourne la borne d'erreur maximale de l'horloge locale : délai racine / 2 + dispersion racine.
+ * @param epoch Heure UTC courante [s].
+ * @return Un temps en microsecondes, UINT32_MAX tant que l'horloge n'a jamais été synchronisée.
+ */
+    uint32_t getMaxError(const unsigned long epoch) const {
+      if (!rootEpoch) return UINT32_MAX;
+      const uint64_t e = rootDelay / 2 + uint64_t(getRootDispersion(epoch));
+      return e > UINT32_MAX ? UINT32_MAX : uint32_t(e);
+    }
+
+  private:
+    uint8_t pollExp;        // Exposant de polling courant.
+    uint8_t pollFloor;      // Exposant minimal (imposé par un Kiss-o'-Death RATE).
+    int     pollCount;      // Compteur d'hystérésis (RFC 5905 poll-adjust).
+    unsigned samples;       // Nombre de mesures prises en compte.
+
+    double jitter;          // [µs]
+    double adev;            // [s/s]
+    double avar;            // Moyenne glissante de (y[i] - y[i-1])^2, [ppm^2].
+
+    int64_t lastOffset;     // [µs]
+    int64_t lastPhase;      // Phase libre de l'oscillateur (offset + corrections cumulées) [µs].
+    int64_t corrections;    // Corrections cumulées [µs].
+    double  lastFreq;       // [ppm]
+    double  frequency;      // Moyenne glissante de la fréquence [ppm].
+    unsigned long lastEpoch;
+
+    bool     restored;        // Fréquence reprise au démarrage.
+    bool     predicted;       // Prédiction thermique disponible.
+    double   prediction;      // [ppm]
+    unsigned long tickEpoch;  // Dernière correction de tick() [s].
+    double   tickResidue;     // Fraction de µs non encore appliquée.
+    int64_t  tickApplied;     // Corrections de tick() depuis la dernière mesure [µs].
+    double   lastResidual;    // Fréquence résiduelle (hors corrections de tick()) du dernier intervalle [ppm].
+
+    uint32_t rootDelay;     // [µs]
+    uint32_t rootDisp;      // [µs], à rootEpoch.
+    unsigned long rootEpoch;
+};
@@ -0,0 +1,127 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "drift.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(__linux__)
+#include <Preferences.h>
+#endif
+
+static void put32(uint8_t* p, const uint32_t v) {
+  p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;
+}
+
+static uint32_t get32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+#if !defined(__linux__)
+bool NvsStore::load(uint8_t data[], const size_t size) {
+  Preferences prefs;
+  if (!prefs.begin(space, true)) return false;
+  const bool ok = (prefs.getBytesLength(key) == size) && (prefs.getBytes(key, data, size) == size);
+  prefs.end();
+  return ok;
+}
+
+bool NvsStore::store(const uint8_t data[], const size_t size) {
+  Preferences prefs;
+  if (!prefs.begin(space, false)) return false;
+  const bool ok = prefs.putBytes(key, data, size) == size;
+  prefs.end();
+  return ok;
+}
+#endif
+
+bool FileStore::load(uint8_t data[], const size_t size) {
+  FILE* const f = fopen(path, "rb");
+  if (!f) return false;
+  const bool ok = (fread(data, 1, size, f) == size) && (fgetc(f) == EOF);
+  fclose(f);
+  return ok;
+}
+
+bool FileStore::store(const uint8_t data[], const size_t size) {
+  char tmp[256];
+  if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= int(sizeof(tmp))) return false;
+  FILE* const f = fopen(tmp, "wb");
+  if (!f) return false;
+  bool ok = fwrite(data, 1, size, f) == size;
+  ok = (fclose(f) == 0) && ok;
+  return ok && !rename(tmp, path);
+}
+
+DriftFile::DriftFile(DriftStore& aStore, const unsigned long aInterval) :
+  store(aStore),
+  interval(aInterval),
+  lastWrite(0)
+{}
+
+uint32_t DriftFile::crc32(const uint8_t data[], const size_t size) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= data[i];
+    for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+bool DriftFile::load(DriftRecord& record) {
+  uint8_t data[DRIFT_SIZE];
+  if (!store.load(data, sizeof(data))) return false;
+  if (memcmp(data, "NTPD", 4) || (data[4] != DRIFT_VERSION)) return false;
+  if (get32(data + DRIFT_SIZE - 4) != crc32(data, DRIFT_SIZE - 4)) return false;
+
+  record.count = data[5] < DRIFT_SERVERS ? data[5] : DRIFT_SERVERS;
+  record.frequency = int32_t(get32(data + 8)) / 65536.0;
+  record.epoch = get32(data + 12);
+  for (uint8_t i = 0; i < DRIFT_SERVERS; ++i) {
+    const uint8_t* const p = data + 16 + 8 * i;
+    memcpy(record.servers[i].ip, p, 4);
+    record.servers[i].denied = p[4] & 1;
+    record.servers[i].poll = (p[6] << 8) | p[7];
+  }
+  return true;
+}
+
+bool DriftFile::save(const DriftRecord& record, const bool force) {
+  if (!force && lastWrite && (record.epoch - lastWrite < interval)) return false;
+
+  uint8_t data[DRIFT_SIZE] = {};
+  memcpy(data, "NTPD", 4);
+  data[4] = DRIFT_VERSION;
+  data[5] = record.count < DRIFT_SERVERS ? record.count : DRIFT_SERVERS;
+  const double f = record.frequency > 32767 ? 32767 : (record.frequency < -32767 ? -32767 : record.frequency);
+  put32(data + 8, uint32_t(int32_t(lround(f * 65536))));
+  put32(data + 12, record.epoch);
+  for (uint8_t i = 0; i < data[5]; ++i) {
+    uint8_t* const p = data + 16 + 8 * i;
+    memcpy(p, record.servers[i].ip, 4);
+    p[4] = record.servers[i].denied ? 1 : 0;
+    p[6] = record.servers[i].poll >> 8;
+    p[7] = record.servers[i].poll;
+  }
+  put32(data + DRIFT_SIZE - 4, crc32(data, DRIFT_SIZE - 4));
+
+  if (!store.store(data, sizeof(data))) return false;
+  lastWrite = record.epoch;
+  return true;
+}
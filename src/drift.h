@@ -0,0 +1,141 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#define DRIFT_VERSION 1
+#define DRIFT_SERVERS 4     // Associations conservées.
+#define DRIFT_SIZE    52    // Taille de l'enregistrement sérialisé [octets].
+
+/**
+ * Etat conservé d'un démarrage à l'autre : fréquence de l'oscillateur, dernière heure valide et associations.
+ */
+struct DriftRecord {
+  double        frequency;  // [ppm]
+  unsigned long epoch;      // Dernière heure UTC synchronisée [s depuis 1970].
+  uint8_t       count;      // Associations renseignées.
+  struct {
+    uint8_t     ip[4];
+    bool        denied;     // Kiss-o'-Death DENY ou RSTR.
+    uint16_t    poll;       // [s]
+  } servers[DRIFT_SERVERS];
+};
+
+/**
+ * Support de l'enregistrement : NVS sur l'ESP32, fichier sur la version hôte.
+ */
+class DriftStore {
+  public:
+/**
+ * Lit l'enregistrement brut.
+ * @param data Reçoit les octets lus.
+ * @param size Taille attendue.
+ * @return Faux s'il n'y a pas d'enregistrement de cette taille.
+ */
+    virtual bool load(uint8_t data[], const size_t size) = 0;
+
+/**
+ * Remplace l'enregistrement brut.
+ * @return Faux en cas d'échec d'écriture.
+ */
+    virtual bool store(const uint8_t data[], const size_t size) = 0;
+
+    virtual ~DriftStore() {}
+};
+
+/**
+ * Enregistrement dans la partition NVS de l'ESP32 (Preferences). Non disponible dans la version hôte.
+ */
+class NvsStore : public DriftStore {
+  public:
+/**
+ * Public constructor.
+ * @param aSpace Espace de noms NVS (15 caractères au plus).
+ * @param aKey Clef de l'enregistrement.
+ */
+    NvsStore(const char aSpace[], const char aKey[]) : space(aSpace), key(aKey) {}
+
+    bool load(uint8_t data[], const size_t size) override;
+    bool store(const uint8_t data[], const size_t size) override;
+
+  private:
+    const char* const space;
+    const char* const key;
+};
+
+/**
+ * Enregistrement dans un fichier ; l'écriture passe par un fichier temporaire renommé pour rester atomique.
+ */
+class FileStore : public DriftStore {
+  public:
+/**
+ * Public constructor.
+ * @param aPath Chemin du fichier (moins de 250 caractères).
+ */
+    FileStore(const char aPath[]) : path(aPath) {}
+
+    bool load(uint8_t data[], const size_t size) override;
+    bool store(const uint8_t data[], const size_t size) override;
+
+  private:
+    const char* const path;
+};
+
+/**
+ * Fichier de dérive (drift file) : enregistrement compact, versionné et protégé par un CRC-32, dont les
+ * écritures sont espacées d'au moins un intervalle pour ménager la flash.
+ *
+ * Format (grand-boutiste) : "NTPD", version, nombre d'associations, 2 octets réservés, fréquence en ppm
+ * au format 16.16 signé, heure UTC [s], DRIFT_SERVERS x (IPv4, drapeaux, réservé, polling [s]), CRC-32.
+ */
+class DriftFile {
+  public:
+/**
+ * Public constructor.
+ * @param aStore Support de l'enregistrement.
+ * @param aInterval Intervalle minimal entre deux écritures [s].
+ */
+    DriftFile(DriftStore& aStore, const unsigned long aInterval);
+
+/**
+ * Lit et vérifie l'enregistrement.
+ * @param record Reçoit l'état conservé.
+ * @return Faux si l'enregistrement est absent, d'une autre version ou corrompu.
+ */
+    bool load(DriftRecord& record);
+
+/**
+ * Ecrit l'enregistrement si le dernier date d'au moins l'intervalle (ou si force).
+ * @param record Etat à conserver ; record.epoch sert aussi à l'espacement des écritures.
+ * @param force Ecrit sans attendre (changement rare mais important, comme un KoD DENY).
+ * @return Vrai si l'enregistrement a été écrit.
+ */
+    bool save(const DriftRecord& record, const bool force = false);
+
+/**
+ * Calcule le CRC-32 (IEEE 802.3) d'un bloc.
+ */
+    static uint32_t crc32(const uint8_t data[], const size_t size);
+
+  private:
+    DriftStore&   store;
+    unsigned long interval;   // [s]
+    unsigned long lastWrite;  // [s depuis 1970], 0 si rien n'a été écrit depuis le démarrage.
+};
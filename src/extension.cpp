@@ -0,0 +1,66 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "extension.h"
+
+ExtensionBuilder::ExtensionBuilder(uint8_t aBuffer[], const size_t aCapacity, const size_t aStart) :
+  buffer(aBuffer),
+  capacity(aCapacity),
+  pos(aStart),
+  last(aStart)
+{}
+
+void ExtensionBuilder::header(const NTP& ntp) {
+  memcpy(buffer, ntp.packetAddr(), NTP::packetSize());
+  pos = NTP::packetSize();
+  last = pos;
+}
+
+uint8_t* ExtensionBuilder::reserve(const uint16_t type, const size_t valueLength) {
+  size_t length = 4 + ((valueLength + 3) & ~size_t(3));
+  if (length < EXT_MIN_LENGTH) length = EXT_MIN_LENGTH;
+  if ((length > 0xFFFF) || (length > capacity - pos)) return nullptr;
+
+  uint8_t* const field = buffer + pos;
+  field[0] = type >> 8;
+  field[1] = type & 0xFF;
+  field[2] = length >> 8;
+  field[3] = length & 0xFF;
+  memset(field + 4, 0, length - 4);
+  last = pos;
+  pos += length;
+  return field + 4;
+}
+
+bool ExtensionBuilder::add(const uint16_t type, const uint8_t value[], const size_t valueLength) {
+  uint8_t* const p = reserve(type, valueLength);
+  if (!p) return false;
+  memcpy(p, value, valueLength);
+  return true;
+}
+
+size_t ExtensionBuilder::finish() {
+  if (last == pos) return pos;
+  const size_t length = pos - last;
+  if (length >= EXT_LAST_LENGTH) return pos;
+  if (EXT_LAST_LENGTH - length > capacity - pos) return 0;
+
+  memset(buffer + pos, 0, EXT_LAST_LENGTH - length);
+  buffer[last + 2] = EXT_LAST_LENGTH >> 8;
+  buffer[last + 3] = EXT_LAST_LENGTH & 0xFF;
+  pos = last + EXT_LAST_LENGTH;
+  return pos;
+}
@@ -0,0 +1,153 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "ntp.h"
+
+/**
+ * Taille minimale d'un champ d'extension (RFC 7822 §3) et du dernier champ quand aucun MAC ne le suit (§7.5).
+ */
+#define EXT_MIN_LENGTH 16
+#define EXT_LAST_LENGTH 28
+
+/**
+ * Au-delà du dernier champ d'extension, ce qui reste (24 octets au plus) est un MAC.
+ */
+#define EXT_MAX_MAC 24
+
+/**
+ * Vue sur un champ d'extension NTPv4, sans copie : value pointe dans le datagramme.
+ */
+struct ExtensionField {
+  uint16_t       type;
+  uint16_t       length;   // taille totale, entête compris.
+  const uint8_t* value;
+
+  uint16_t valueLength() const { return length - 4; }
+};
+
+/**
+ * Parcours des champs d'extension d'un datagramme NTPv4 (RFC 7822), sans copie et borné par sa taille.
+ *
+ * Le parcours s'arrête sur le MAC éventuel (offset() le désigne alors) ou sur le premier champ mal formé
+ * (isValid() devient faux) : un champ ne peut jamais déborder du datagramme.
+ */
+class ExtensionIterator {
+  public:
+/**
+ * Public constructor.
+ * @param packet Datagramme complet (entête de 48 octets compris).
+ * @param len Sa taille.
+ * @param start Position du premier champ (après l'entête par défaut).
+ * @param mac Faux si aucun MAC ne peut suivre les champs (champs chiffrés de NTS par exemple).
+ */
+    ExtensionIterator(const uint8_t aPacket[], const size_t aLen, const size_t aStart = NTP::packetSize(), const bool aMac = true) :
+      packet(aPacket),
+      len(aLen),
+      pos(aStart),
+      mac(aMac ? EXT_MAX_MAC : 0),
+      valid(aStart <= aLen)
+    {}
+
+/**
+ * Passe au champ suivant.
+ * @param field Reçoit le champ.
+ * @return Faux à la fin des champs ou sur un champ mal formé.
+ */
+    bool next(ExtensionField& field) {
+      if (!valid || (len - pos <= mac)) return false;   // fin, ou MAC.
+      if (len - pos < 4) {                                // reste trop court pour un entête de champ.
+        valid = false;
+        return false;
+      }
+      const uint16_t length = (packet[pos + 2] << 8) | packet[pos + 3];
+      if ((length < EXT_MIN_LENGTH) || (length & 3) || (length > len - pos)) {
+        valid = false;
+        return false;
+      }
+      field.type = (packet[pos] << 8) | packet[pos + 1];
+      field.length = length;
+      field.value = packet + pos + 4;
+      pos += length;
+      return true;
+    }
+
+/**
+ * Position courante : celle du MAC (ou la fin du datagramme) une fois tous les champs parcourus.
+ */
+    size_t offset() const { return pos; }
+
+    bool isValid() const { return valid; }
+
+  private:
+    const uint8_t* const packet;
+    const size_t         len;
+    size_t               pos;
+    const size_t         mac;
+    bool                 valid;
+};
+
+/**
+ * Ajout de champs d'extension à la suite de l'entête, dans un tampon de taille fixe.
+ */
+class ExtensionBuilder {
+  public:
+/**
+ * Public constructor.
+ * @param buffer Tampon du datagramme ; l'entête y est copié par header() ou par l'appelant.
+ * @param capacity Taille du tampon.
+ * @param start Position du premier champ (après l'entête par défaut).
+ */
+    ExtensionBuilder(uint8_t buffer[], const size_t capacity, const size_t start = NTP::packetSize());
+
+/**
+ * Copie l'entête du paquet au début du tampon et recommence la construction.
+ */
+    void header(const NTP& ntp);
+
+/**
+ * Réserve un champ dont la valeur sera écrite sur place (complétée de zéros).
+ * @param type Type du champ.
+ * @param valueLength Taille de la valeur.
+ * @return Pointeur sur la valeur, ou nullptr si le tampon est plein.
+ */
+    uint8_t* reserve(const uint16_t type, const size_t valueLength);
+
+/**
+ * Ajoute un champ.
+ * @return Faux si le tampon est plein.
+ */
+    bool add(const uint16_t type, const uint8_t value[], const size_t valueLength);
+
+/**
+ * Taille construite jusqu'ici (données authentifiées d'un champ réservé ensuite).
+ */
+    size_t size() const { return pos; }
+
+/**
+ * Termine le datagramme : sans MAC à suivre, le dernier champ est allongé à 28 octets pour ne pas être pris
+ * pour un MAC (RFC 7822 §7.5).
+ * @return La taille du datagramme, 0 si le tampon est trop petit.
+ */
+    size_t finish();
+
+  private:
+    uint8_t* const buffer;
+    const size_t   capacity;
+    size_t         pos;
+    size_t         last;   // position du dernier champ ajouté (pos si aucun).
+};
@@ -0,0 +1,97 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "interleaved.h"
+
+InterleavedClient::InterleavedClient() :
+  last(NTP::makeNTP(NTPMODE_SERVER)),
+  hasLast(false),
+  cookie(0),
+  expected(0),
+  tx(0),
+  lastTx(0),
+  interleaved(false),
+  corrected(0),
+  stale(0)
+{}
+
+void InterleavedClient::prepare(NTP& request) const {
+  if (!hasLast) return;
+  request.setOriginFromReceive(last);
+  request.setT1(last.getT3());
+}
+
+void InterleavedClient::sent(const NTP& request, const uint64_t& aTx) {
+  cookie = request.getT2();
+  expected = request.getT1();
+  tx = aTx;
+}
+
+bool InterleavedClient::receive(NTP& reply, const int64_t corrections) {
+  const auto org = reply.getT0();
+  if (!cookie || !org) return false;
+
+  if (org == cookie) {                    // réponse simple.
+    interleaved = false;
+    stale = 0;
+    corrected = corrections;
+    last = reply;
+    lastTx = tx;
+    hasLast = true;
+    cookie = 0;
+    return true;
+  }
+
+  if (!hasLast || (org != expected) || !lastTx) return false;
+
+// Réponse entrelacée : mesure de l'échange précédent.
+  const NTP current = reply;
+  reply.setOriginTime(lastTx);            // T0 réel de la requête précédente.
+  reply.setT1(last.getT1());              // réception de la requête précédente par le serveur.
+  reply.setT3(last.getT3());              // réception de la réponse précédente ; Transmit = émission réelle.
+  interleaved = true;
+  stale = corrections - corrected;        // l'horloge a été corrigée depuis la réception de last.
+  corrected = corrections;
+  last = current;
+  lastTx = tx;
+  cookie = 0;
+  return true;
+}
+
+InterleavedServer::InterleavedServer() :
+  table()
+{}
+
+unsigned InterleavedServer::slot(const uint32_t ip) {
+  return ((ip * 2654435761U) >> 16) % INTERLEAVED_SLOTS;
+}
+
+bool InterleavedServer::prepare(const Endpoint& client, const NTP& request, NTP& reply) const {
+  const Entry& e = table[slot(client.ip)];
+  const auto org = request.getT0();
+  if ((e.ip != client.ip) || !org || (org != e.rx) || !e.tx) return false;
+
+  reply.setOriginFromReceive(request);
+  reply.setT0(e.tx);
+  return true;
+}
+
+void InterleavedServer::sent(const Endpoint& client, const NTP& reply, const uint64_t& tx) {
+  Entry& e = table[slot(client.ip)];
+  e.ip = client.ip;
+  e.rx = reply.getT1();
+  e.tx = tx;
+}
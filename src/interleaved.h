@@ -0,0 +1,134 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "transport.h"
+
+/**
+ * Nombre de clients dont le serveur garde les horodatages pour le mode entrelacé.
+ */
+#define INTERLEAVED_SLOTS 64
+
+/**
+ * Mode entrelacé client/serveur, côté client.
+ *
+ * Chaque requête porte dans Origin le Receive de la réponse précédente et dans Receive l'heure locale de sa
+ * réception. Un serveur qui le gère renvoie alors dans Transmit l'heure réelle d'émission de sa réponse
+ * précédente, prise après l'envoi : la mesure porte sur l'échange précédent, avec des horodatages d'émission
+ * pris après l'envoi des deux côtés.
+ * @see https://www.rfc-editor.org/rfc/rfc9769
+ */
+class InterleavedClient {
+  public:
+/**
+ * Public constructor.
+ */
+    InterleavedClient();
+
+/**
+ * Complète une requête avant l'envoi (Origin et Receive).
+ * @param request Requête client.
+ */
+    void prepare(NTP& request) const;
+
+/**
+ * Mémorise la requête qui vient de partir.
+ * @param request Requête envoyée (champ Transmit estampillé).
+ * @param tx Heure réelle de fin d'émission (Transport::lastTransmit()).
+ */
+    void sent(const NTP& request, const uint64_t& tx);
+
+/**
+ * Apparie une réponse à la dernière requête ; une réponse entrelacée est réécrite en échange simple
+ * équivalent (Origin = T0 précis, Receive = T1, Transmit = T2 précis, T3), getOffset() et getRTT() s'appliquent.
+ * @param reply Réponse reçue (T3 = heure de réception).
+ * @param corrections Cumul des corrections appliquées à l'horloge locale (Discipline::getCorrections()) [µs].
+ * @return Faux si la réponse ne correspond pas à la dernière requête.
+ */
+    bool receive(NTP& reply, const int64_t corrections = 0);
+
+/**
+ * Retourne l'offset d'une réponse acceptée, ramené à l'horloge locale actuelle : une réponse entrelacée mesure
+ * l'échange précédent, les corrections appliquées depuis sa réception en sont retranchées.
+ * @param reply Réponse passée à receive().
+ * @return Ecart signé en microsecondes.
+ */
+    int64_t getOffset(const NTP& reply) const { return reply.getOffset() - stale; }
+
+/**
+ * Indique si la dernière réponse acceptée était entrelacée.
+ * @return Vrai pour une réponse entrelacée.
+ */
+    bool isInterleaved() const { return interleaved; }
+
+/**
+ * Oublie la dernière réponse (rejetée par les tests) : la prochaine requête repart d'un échange simple.
+ */
+    void reset() { hasLast = false; interleaved = false; stale = 0; }
+
+  private:
+    NTP      last;        // dernière réponse acceptée, non réécrite (T3 = réception).
+    bool     hasLast;
+    uint64_t cookie;      // Transmit de la dernière requête, tel qu'encodé.
+    uint64_t expected;    // Receive de la dernière requête, tel qu'encodé (Origin d'une réponse entrelacée).
+    uint64_t tx;          // Emission réelle de la dernière requête [µs].
+    uint64_t lastTx;      // Emission réelle de la requête à laquelle répondait last [µs].
+    bool     interleaved;
+    int64_t  corrected;   // Cumul des corrections à la réception de last [µs].
+    int64_t  stale;       // Corrections appliquées depuis l'échange mesuré par la dernière réponse [µs].
+};
+
+/**
+ * Mode entrelacé client/serveur, côté serveur : garde, par client, l'heure de réception de sa dernière requête
+ * et l'heure réelle d'émission de la réponse. Table de taille fixe à accès direct ; une collision fait
+ * simplement retomber le client en mode simple.
+ */
+class InterleavedServer {
+  public:
+/**
+ * Public constructor.
+ */
+    InterleavedServer();
+
+/**
+ * Prépare la réponse : entrelacée si l'Origin de la requête est la réception mémorisée pour ce client.
+ * @param client Adresse du client.
+ * @param request Requête reçue.
+ * @param reply Réponse préparée par Responder::respond().
+ * @return Vrai si la réponse est entrelacée : elle est alors complète et doit partir sans estampille.
+ */
+    bool prepare(const Endpoint& client, const NTP& request, NTP& reply) const;
+
+/**
+ * Mémorise les horodatages de la réponse envoyée.
+ * @param client Adresse du client.
+ * @param reply Réponse envoyée.
+ * @param tx Heure réelle de fin d'émission (Transport::lastTransmit()).
+ */
+    void sent(const Endpoint& client, const NTP& reply, const uint64_t& tx);
+
+  private:
+    struct Entry {
+      uint32_t ip;
+      uint64_t rx;   // Receive de la dernière réponse, tel qu'encodé.
+      uint64_t tx;   // Emission réelle de la dernière réponse.
+    };
+
+    static unsigned slot(const uint32_t ip);
+
+    Entry table[INTERLEAVED_SLOTS];
+};
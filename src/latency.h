@@ -0,0 +1,61 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Statistiques d'une série de durées (moyenne, écart-type, maximum), remises à zéro à chaque rapport.
+ */
+class LatencyStats {
+  public:
+/**
+ * Public constructor.
+ */
+    LatencyStats() : count(0), sum(0), sum2(0), max(0) {}
+
+/**
+ * Ajoute une durée [µs].
+ */
+    void add(const int64_t micros) {
+      ++count;
+      sum += micros;
+      sum2 += double(micros) * micros;
+      if (micros > max) max = micros;
+    }
+
+/**
+ * Nombre de durées, puis moyenne, écart-type et maximum [µs].
+ */
+    unsigned getCount() const { return count; }
+    double getMean() const { return count ? sum / count : 0; }
+    double getDeviation() const { return count > 1 ? sqrt((sum2 - sum * sum / count) / (count - 1)) : 0; }
+    int64_t getMax() const { return max; }
+
+/**
+ * Remet la série à zéro.
+ */
+    void reset() { *this = LatencyStats(); }
+
+  private:
+    unsigned count;
+    double   sum;     // [µs]
+    double   sum2;    // [µs²]
+    int64_t  max;     // [µs]
+};
@@ -0,0 +1,125 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "leap.h"
+
+#include <ctime>
+
+#define UNIX1900 2208988800UL
+
+/**
+ * Secondes intercalaires insérées (IERS, leap-seconds.list) : minuit UTC suivant chaque seconde, en secondes
+ * NTP. Les annonces du Bulletin C de l'IERS s'ajoutent en fin de table et repoussent LEAPS_EXPIRE.
+ */
+static const uint32_t LEAPS[] = {
+  2287785600UL, 2303683200UL, 2335219200UL, 2366755200UL, 2398291200UL, 2429913600UL, 2461449600UL,
+  2492985600UL, 2524521600UL, 2571782400UL, 2603318400UL, 2634854400UL, 2698012800UL, 2776982400UL,
+  2840140800UL, 2871676800UL, 2918937600UL, 2950473600UL, 2982009600UL, 3029443200UL, 3076704000UL,
+  3124137600UL, 3345062400UL, 3439756800UL, 3550089600UL, 3644697600UL, 3692217600UL
+};
+
+/**
+ * Fin de validité de la table (ligne "#@" de leap-seconds.list, 28 juin 2027, après le Bulletin C 72) en secondes NTP : au-delà,
+ * l'absence de seconde intercalaire n'est plus garantie et seul l'amont fait foi.
+ */
+#define LEAPS_EXPIRE 4023129600UL
+
+Leap::Leap(const bool aSmear, const bool aTable) :
+  smear(aSmear),
+  table(aTable),
+  pending(0),
+  when(0),
+  repeating(false)
+{}
+
+unsigned long Leap::endOfMonth(const unsigned long epoch) {
+  const time_t t = epoch;
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  int y = tm.tm_year + 1900;
+  int m = tm.tm_mon + 2;    // mois suivant, 1..13
+  if (m > 12) {
+    m = 1;
+    ++y;
+  }
+  // Jours depuis le 1er janvier 1970 (algorithme de H. Hinnant, days_from_civil).
+  y -= m <= 2;
+  const long era = y / 400;
+  const unsigned yoe = y - era * 400;
+  const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return (era * 146097L + doe - 719468L) * 86400UL;
+}
+
+void Leap::update(const uint8_t li, const unsigned long epoch) {
+  if (repeating) return;
+  const unsigned long end = endOfMonth(epoch);
+
+  if ((li == 1) || (li == 2)) {
+    pending = li;
+    when = end;
+    return;
+  }
+
+  if (table && (end <= LEAPS_EXPIRE - UNIX1900)) {
+    for (const auto leap : LEAPS) {
+      const unsigned long t = leap - UNIX1900;
+      if ((t > epoch) && (t <= end)) {
+        pending = 1;
+        when = t;
+        return;
+      }
+    }
+  }
+
+  // L'amont ne l'annonce plus : abandon, sauf si le lissage a commencé.
+  if (pending && (epoch + LEAP_SMEAR_WINDOW < when)) pending = 0;
+}
+
+int Leap::tick(const unsigned long epoch) {
+  if (repeating) {          // fin de 23:59:60.
+    if (epoch >= when) repeating = false;
+    return 0;
+  }
+  if (!pending) return 0;
+
+  if ((pending == 1) && (epoch >= when)) {
+    pending = 0;
+    repeating = !smear;
+    return -1;
+  }
+  if ((pending == 2) && (epoch + 1 >= when)) {
+    pending = 0;
+    return 1;
+  }
+  return 0;
+}
+
+uint64_t Leap::civil(const uint64_t t) const {
+  if (!smear || !pending) return t;
+
+  const uint64_t end = (when + UNIX1900) * 1000000ULL;
+  const uint64_t window = LEAP_SMEAR_WINDOW * 1000000ULL;
+  if (t + window <= end) return t;
+
+  // Au-delà de la fin du lissage, le décalage reste d'une seconde jusqu'au saut de l'horloge locale (tick()).
+  const uint64_t shift = t >= end ? 1000000ULL : (t + window - end) / LEAP_SMEAR_WINDOW;   // 0..1 s, en µs.
+  return pending == 1 ? t - shift : t + shift;
+}
+
+bool Leap::isExpired(const unsigned long epoch) const {
+  return table && (epoch >= LEAPS_EXPIRE - UNIX1900);
+}
@@ -0,0 +1,101 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Durée du lissage (smear) d'une seconde intercalaire, terminé à l'instant de la seconde [s].
+ */
+#define LEAP_SMEAR_WINDOW 86400
+
+/**
+ * Seconde intercalaire annoncée par l'amont (bits LI) ou par la table embarquée.
+ *
+ * L'horloge locale reste en UTC et fait le saut à l'instant de la seconde : elle repasse par 23:59:59
+ * (insertion, affichée 23:59:60) ou saute 23:59:59 (suppression), comme les serveurs amont.
+ * En mode lissage, l'heure publiée (affichage et réponses du serveur, via civil()) est décalée linéairement
+ * pendant les 24 h précédentes, si bien que le saut de l'horloge locale n'y est pas visible ; les clients
+ * ne reçoivent alors pas d'annonce LI.
+ */
+class Leap {
+  public:
+/**
+ * Public constructor.
+ * @param smear Lisse la seconde sur LEAP_SMEAR_WINDOW au lieu de l'insérer.
+ * @param table Consulte aussi la table des secondes intercalaires embarquée.
+ */
+    Leap(const bool smear, const bool table);
+
+/**
+ * Prend en compte l'indicateur LI d'une réponse valide de l'amont ; la table embarquée n'est plus consultée
+ * après sa date d'expiration.
+ * @param li Indicateur reçu (0, 1 insertion ou 2 suppression en fin de mois).
+ * @param epoch Heure UTC courante [s depuis 1970].
+ */
+    void update(const uint8_t li, const unsigned long epoch);
+
+/**
+ * A appeler à chaque nouvelle seconde de l'horloge locale.
+ * @param epoch Heure UTC courante [s depuis 1970].
+ * @return Le saut à appliquer à l'horloge locale [s] : -1 à l'insertion, +1 à la suppression, 0 sinon.
+ */
+    int tick(const unsigned long epoch);
+
+/**
+ * Indique que l'horloge locale repasse par 23:59:59 à afficher 23:59:60 (insertion sans lissage).
+ */
+    bool isLeapSecond() const { return repeating; }
+
+/**
+ * Retourne l'indicateur LI à annoncer aux clients du serveur.
+ * @return 0, 1 ou 2 ; toujours 0 en mode lissage.
+ */
+    uint8_t announce() const { return smear ? 0 : pending; }
+
+/**
+ * Retourne l'instant de la seconde intercalaire en attente.
+ * @return Heure UTC [s depuis 1970] de minuit suivant la seconde, 0 si aucune n'est en attente.
+ */
+    unsigned long getTime() const { return pending ? when : 0; }
+
+/**
+ * Convertit l'heure de l'horloge locale en heure publiée (lissée si besoin).
+ * @param t Le temps en microsecondes depuis le 1er janvier 1900.
+ * @return Le temps publié en microsecondes depuis le 1er janvier 1900.
+ */
+    uint64_t civil(const uint64_t t) const;
+
+/**
+ * Indique que la table embarquée a dépassé sa date d'expiration : seul l'amont annonce alors les secondes.
+ * @param epoch Heure UTC courante [s depuis 1970].
+ * @return Faux si la table n'est pas consultée.
+ */
+    bool isExpired(const unsigned long epoch) const;
+
+  private:
+/**
+ * Retourne le début du mois suivant celui de epoch (minuit UTC).
+ */
+    static unsigned long endOfMonth(const unsigned long epoch);
+
+    const bool    smear;
+    const bool    table;
+    uint8_t       pending;    // 0, 1 (insertion) ou 2 (suppression).
+    unsigned long when;       // minuit UTC suivant la seconde [s depuis 1970].
+    bool          repeating;  // seconde insérée en cours.
+};
@@ -0,0 +1,220 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#if defined(__linux__)
+
+#include "linux_nts.h"
+#include "extension.h"
+
+#include <mbedtls/cmac.h>
+#include <cstdio>
+#include <netdb.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+
+#define COOKIE_NONCE 16
+#define COOKIE_KEYS 64
+
+static inline uint16_t get16(const uint8_t p[]) { return (p[0] << 8) | p[1]; }
+static inline void put16(uint8_t p[], const uint16_t v) { p[0] = v >> 8; p[1] = v; }
+static inline size_t pad4(const size_t n) { return (n + 3) & ~size_t(3); }
+
+StandInChannel::StandInChannel(const uint8_t aPsk[16], const int aFd) :
+  fd(aFd)
+{
+  memcpy(psk, aPsk, sizeof(psk));
+}
+
+StandInChannel::~StandInChannel() {
+  if (fd >= 0) close(fd);
+}
+
+bool StandInChannel::connect(const char host[], const uint16_t port) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* res = nullptr;
+  char service[6];
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &res) || !res) return false;
+
+  if (fd >= 0) close(fd);
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  const bool ok = (fd >= 0) && !::connect(fd, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  return ok;
+}
+
+bool StandInChannel::write(const uint8_t data[], const size_t len) {
+  for (size_t done = 0; done < len; ) {
+    const ssize_t n = ::send(fd, data + done, len - done, MSG_NOSIGNAL);
+    if (n <= 0) return false;
+    done += n;
+  }
+  return true;
+}
+
+bool StandInChannel::read(uint8_t data[], const size_t len) {
+  for (size_t done = 0; done < len; ) {
+    const ssize_t n = ::recv(fd, data + done, len - done, 0);
+    if (n <= 0) return false;
+    done += n;
+  }
+  return true;
+}
+
+bool StandInChannel::exportKey(const char label[], const uint8_t context[], const size_t contextLen, uint8_t out[], const size_t len) {
+  mbedtls_cipher_context_t ctx;
+  mbedtls_cipher_init(&ctx);
+  bool ok = !mbedtls_cipher_setup(&ctx, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB))
+         && !mbedtls_cipher_cmac_starts(&ctx, psk, 128);
+
+  // K(i) = CMAC(psk, i || label || 0x00 || context || L)
+  uint8_t block[16];
+  uint8_t length[2];
+  put16(length, len * 8);
+  size_t done = 0;
+  for (uint8_t i = 1; ok && (done < len); ++i) {
+    const uint8_t zero = 0;
+    ok = !mbedtls_cipher_cmac_reset(&ctx)
+      && !mbedtls_cipher_cmac_update(&ctx, &i, 1)
+      && !mbedtls_cipher_cmac_update(&ctx, (const uint8_t*)label, strlen(label))
+      && !mbedtls_cipher_cmac_update(&ctx, &zero, 1)
+      && !mbedtls_cipher_cmac_update(&ctx, context, contextLen)
+      && !mbedtls_cipher_cmac_update(&ctx, length, 2)
+      && !mbedtls_cipher_cmac_finish(&ctx, block);
+    const size_t n = len - done < sizeof(block) ? len - done : sizeof(block);
+    memcpy(out + done, block, n);
+    done += n;
+  }
+  mbedtls_cipher_free(&ctx);
+  return ok;
+}
+
+NtsStandInServer::NtsStandInServer(const uint8_t key[32]) {
+  master.setKey(key);
+}
+
+size_t NtsStandInServer::cookie(const uint8_t keys[COOKIE_KEYS], uint8_t out[NTS_MAX_COOKIE]) {
+  while (getrandom(out, COOKIE_NONCE, 0) != COOKIE_NONCE) {}
+  if (!master.seal(out, COOKIE_NONCE, nullptr, 0, keys, COOKIE_KEYS, out + COOKIE_NONCE)) return 0;
+  return COOKIE_NONCE + 16 + COOKIE_KEYS;
+}
+
+bool NtsStandInServer::exchange(NtsKeChannel& channel) {
+  bool protocol = false;
+  bool aead = false;
+  for (;;) {
+    uint8_t head[4];
+    uint8_t body[64];
+    if (!channel.read(head, 4)) return false;
+    const uint16_t type = get16(head) & 0x7FFF;
+    const size_t len = get16(head + 2);
+    if ((len > sizeof(body)) || (len && !channel.read(body, len))) return false;
+    if (type == 0) break;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+      if ((type == 1) && (get16(body + i) == 0)) protocol = true;
+      if ((type == 4) && (get16(body + i) == 15)) aead = true;
+    }
+  }
+  if (!protocol || !aead) return false;
+
+  uint8_t context[5] = { 0, 0, 0, 15, 0x00 };
+  uint8_t keys[COOKIE_KEYS];
+  if (!channel.exportKey("EXPORTER-network-time-security", context, sizeof(context), keys, 32)) return false;
+  context[4] = 0x01;
+  if (!channel.exportKey("EXPORTER-network-time-security", context, sizeof(context), keys + 32, 32)) return false;
+
+  uint8_t out[4 + NTS_MAX_COOKIE];
+  const uint8_t answer[] = { 0x80, 1, 0, 2, 0, 0,  0x80, 4, 0, 2, 0, 15 };
+  if (!channel.write(answer, sizeof(answer))) return false;
+  for (byte i = 0; i < NTS_COOKIES; ++i) {
+    const size_t len = cookie(keys, out + 4);
+    if (!len) return false;
+    put16(out, 5);
+    put16(out + 2, len);
+    if (!channel.write(out, 4 + len)) return false;
+  }
+  const uint8_t end[] = { 0x80, 0, 0, 0 };
+  return channel.write(end, sizeof(end));
+}
+
+size_t NtsStandInServer::respond(const uint8_t request[], const size_t len, const NTP& reply, uint8_t out[NTP_MAX_PACKET]) {
+  ExtensionField uid = {};
+  uint8_t keys[COOKIE_KEYS];
+  bool haveKeys = false;
+  byte wanted = 0;
+  AesSiv c2s;
+  AesSiv s2c;
+
+  bool authentic = false;
+  ExtensionIterator it(request, len);
+  for (ExtensionField field; !authentic && it.next(field); ) {
+    switch (field.type) {
+      case 0x0104:
+        uid = field;
+        break;
+      case 0x0204:
+        if (haveKeys || (field.valueLength() < COOKIE_NONCE + 16 + COOKIE_KEYS)) return 0;
+        if (!master.open(field.value, COOKIE_NONCE, nullptr, 0, field.value + COOKIE_NONCE, 16 + COOKIE_KEYS, keys)) return 0;
+        haveKeys = c2s.setKey(keys) && s2c.setKey(keys + 32);
+        ++wanted;
+        break;
+      case 0x0304:
+        ++wanted;
+        break;
+      case 0x0404: {
+        if (!haveKeys || (field.valueLength() < 4)) return 0;
+        const size_t nonceLen = get16(field.value);
+        const size_t cipherLen = get16(field.value + 2);
+        if (4 + pad4(nonceLen) + pad4(cipherLen) > field.valueLength()) return 0;
+        uint8_t plain[NTP_MAX_PACKET];
+        const size_t aad = field.value - 4 - request;
+        if (!c2s.open(field.value + 4, nonceLen, request, aad, field.value + 4 + pad4(nonceLen), cipherLen, plain)) return 0;
+        authentic = true;
+        break;
+      }
+    }
+  }
+  if (!authentic || !uid.value) return 0;
+
+  ExtensionBuilder builder(out, NTP_MAX_PACKET);
+  builder.header(reply);
+  builder.add(0x0104, uid.value, uid.valueLength());
+
+  // Nouveaux cookies, chiffrés dans l'authentificateur.
+  uint8_t plain[NTP_MAX_PACKET];
+  ExtensionBuilder cookies(plain, NTP_MAX_PACKET - builder.size() - 8 - COOKIE_NONCE - 16, 0);
+  for (byte i = 0; i < wanted; ++i) {
+    uint8_t* const p = cookies.reserve(0x0204, COOKIE_NONCE + 16 + COOKIE_KEYS);
+    if (!p || !cookie(keys, p)) break;
+  }
+  const size_t plainLen = cookies.size();
+
+  const size_t aad = builder.size();
+  uint8_t* const auth = builder.reserve(0x0404, 4 + COOKIE_NONCE + 16 + plainLen);
+  if (!auth) return 0;
+  uint8_t* const nonce = auth + 4;
+  while (getrandom(nonce, COOKIE_NONCE, 0) != COOKIE_NONCE) {}
+  put16(auth, COOKIE_NONCE);
+  put16(auth + 2, 16 + plainLen);
+  if (!s2c.seal(nonce, COOKIE_NONCE, out, aad, plain, plainLen, nonce + COOKIE_NONCE)) return 0;
+  return builder.finish();
+}
+
+#endif
@@ -0,0 +1,83 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#if defined(__linux__)
+
+#include "nts.h"
+
+/**
+ * Canal NTS-KE de substitution pour les essais locaux : TCP en clair, l'exportateur TLS étant remplacé par une
+ * dérivation AES-CMAC (NIST SP 800-108, mode compteur) d'un secret partagé par les deux extrémités.
+ * Il n'apporte aucune confidentialité : il ne sert qu'à exercer le client contre NtsStandInServer.
+ */
+class StandInChannel : public NtsKeChannel {
+  public:
+/**
+ * Public constructor.
+ * @param psk Secret partagé (16 octets).
+ * @param fd Socket TCP déjà connectée (sinon utiliser connect()).
+ */
+    StandInChannel(const uint8_t psk[16], const int fd = -1);
+    ~StandInChannel();
+
+    bool connect(const char host[], const uint16_t port);
+
+    bool write(const uint8_t data[], const size_t len) override;
+    bool read(uint8_t data[], const size_t len) override;
+    bool exportKey(const char label[], const uint8_t context[], const size_t contextLen, uint8_t out[], const size_t len) override;
+
+  private:
+    uint8_t psk[16];
+    int     fd;
+};
+
+/**
+ * Serveur NTS de substitution : répond au NTS-KE sur un canal et authentifie les échanges NTP.
+ * Les cookies contiennent les clés C2S/S2C de l'association, scellées par une clé maîtresse du serveur.
+ */
+class NtsStandInServer {
+  public:
+/**
+ * Public constructor.
+ * @param master Clé maîtresse des cookies (32 octets).
+ */
+    NtsStandInServer(const uint8_t master[32]);
+
+/**
+ * Traite un établissement de clés complet sur le canal.
+ * @return Vrai si la requête était valide et la réponse envoyée.
+ */
+    bool exchange(NtsKeChannel& channel);
+
+/**
+ * Authentifie une requête NTS et construit la réponse.
+ * @param request Datagramme reçu.
+ * @param len Sa taille.
+ * @param reply Entête de la réponse préparé par le Responder.
+ * @param out Datagramme de réponse.
+ * @return Sa taille, 0 si la requête n'est pas authentique.
+ */
+    size_t respond(const uint8_t request[], const size_t len, const NTP& reply, uint8_t out[NTP_MAX_PACKET]);
+
+  private:
+    size_t cookie(const uint8_t keys[64], uint8_t out[NTS_MAX_COOKIE]);
+
+    AesSiv master;
+};
+
+#endif
@@ -0,0 +1,260 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#if defined(__linux__)
+
+#include "linux_server.h"
+
+#include <algorithm>
+#include <ctime>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define POLL_MS 100   // période de vérification de l'arrêt.
+
+/**
+ * Zone de paquets propre à un thread : tout ce dont un lot a besoin, alloué une fois.
+ */
+struct Arena {
+  struct mmsghdr rx[SERVER_BATCH];
+  struct mmsghdr tx[SERVER_BATCH];
+  struct iovec rxIov[SERVER_BATCH];
+  struct iovec txIov[SERVER_BATCH];
+  struct sockaddr_in addr[SERVER_BATCH];
+  uint8_t in[SERVER_BATCH][64];
+  uint8_t out[SERVER_BATCH][64];
+  char control[SERVER_BATCH][64];
+  bool kod[SERVER_BATCH];         // la réponse préparée est un KoD.
+};
+
+static uint64_t toNTP(const struct timespec& ts) {
+  return (uint64_t(ts.tv_sec) + YEAR1970) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uint64_t now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return toNTP(ts);
+}
+
+static uint32_t monotonic() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  return ts.tv_sec * 1000U + ts.tv_nsec / 1000000;
+}
+
+LinuxServer::LinuxServer(const Responder& responder, const unsigned threads, const bool aLimit) :
+  workers(threads ? threads : std::max(1U, std::thread::hardware_concurrency())),
+  running(false),
+  limit(aLimit),
+  lock(),
+  shared(responder),
+  sharedLeap(),
+  generation(0)
+{
+  for (auto& w : workers) {
+    w.fd = -1;
+    w.served = 0;
+    w.kissed = 0;
+    w.rejected = 0;
+    w.dropped = 0;
+  }
+}
+
+LinuxServer::~LinuxServer() {
+  stop();
+}
+
+bool LinuxServer::start(const uint16_t port) {
+  for (auto& w : workers) {
+    w.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    const int on = 1;
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if ((w.fd < 0)
+     || setsockopt(w.fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on))
+     || bind(w.fd, (struct sockaddr*)&addr, sizeof(addr))) {
+      stop();
+      return false;
+    }
+    setsockopt(w.fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+  }
+
+  running = true;
+  for (unsigned i = 0; i < workers.size(); ++i) {
+    workers[i].thread = std::thread(&LinuxServer::run, this, std::ref(workers[i]), i);
+  }
+  return true;
+}
+
+void LinuxServer::stop() {
+  running = false;
+  for (auto& w : workers) {
+    if (w.thread.joinable()) w.thread.join();
+    if (w.fd >= 0) close(w.fd);
+    w.fd = -1;
+  }
+}
+
+void LinuxServer::update(const Responder& responder, const Leap* leap) {
+  std::lock_guard<std::mutex> guard(lock);
+  shared = responder;
+  sharedLeap.reset();
+  if (leap) {
+    sharedLeap.emplace(*leap);
+    shared.setLeap(leap->announce());
+  }
+  ++generation;
+}
+
+uint64_t LinuxServer::served() const {
+  uint64_t total = 0;
+  for (const auto& w : workers) total += w.served;
+  return total;
+}
+
+uint64_t LinuxServer::kissed() const {
+  uint64_t total = 0;
+  for (const auto& w : workers) total += w.kissed;
+  return total;
+}
+
+uint64_t LinuxServer::rejected() const {
+  uint64_t total = 0;
+  for (const auto& w : workers) total += w.rejected;
+  return total;
+}
+
+uint64_t LinuxServer::dropped() const {
+  uint64_t total = 0;
+  for (const auto& w : workers) total += w.dropped;
+  return total;
+}
+
+void LinuxServer::run(Worker& worker, const unsigned cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % CPU_SETSIZE, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+  Arena* const arena = new Arena();
+  RateLimiter* const limiter = new RateLimiter();
+  for (unsigned i = 0; i < SERVER_BATCH; ++i) {
+    arena->rxIov[i] = { arena->in[i], sizeof(arena->in[i]) };
+    arena->txIov[i] = { arena->out[i], NTP::packetSize() };
+  }
+
+  Responder responder = shared;
+  std::optional<Leap> leap;
+  unsigned seen = 0;
+  const auto civil = [&leap](const uint64_t t) { return leap ? leap->civil(t) : t; };
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+
+  while (running) {
+    struct pollfd pfd = { worker.fd, POLLIN, 0 };
+    if (poll(&pfd, 1, POLL_MS) <= 0) continue;
+
+    if (generation != seen) {
+      std::lock_guard<std::mutex> guard(lock);
+      responder = shared;
+      leap.reset();
+      if (sharedLeap) leap.emplace(*sharedLeap);
+      seen = generation;
+    }
+
+    for (unsigned i = 0; i < SERVER_BATCH; ++i) {
+      auto& hdr = arena->rx[i].msg_hdr;
+      hdr.msg_name = &arena->addr[i];
+      hdr.msg_namelen = sizeof(arena->addr[i]);
+      hdr.msg_iov = &arena->rxIov[i];
+      hdr.msg_iovlen = 1;
+      hdr.msg_control = arena->control[i];
+      hdr.msg_controllen = sizeof(arena->control[i]);
+      hdr.msg_flags = 0;
+    }
+    const int nb = recvmmsg(worker.fd, arena->rx, SERVER_BATCH, MSG_DONTWAIT, nullptr);
+    if (nb <= 0) continue;
+    const uint64_t fallback = civil(now());
+    const uint32_t ms = monotonic();
+
+    unsigned out = 0;
+    unsigned ignored = 0;
+    for (int i = 0; i < nb; ++i) {
+      if (arena->rx[i].msg_len != NTP::packetSize()) {  // MAC ou champs d'extension : pas de trousseau ici.
+        ++ignored;
+        continue;
+      }
+      auto& hdr = arena->rx[i].msg_hdr;
+      uint64_t rx = fallback;
+      for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS))
+          rx = civil(toNTP(*(const struct timespec*)CMSG_DATA(cmsg)));
+      }
+      request.setPacket(arena->in[i]);
+      request.setT3(rx);
+      if (!responder.respond(request, reply)) {
+        ++ignored;
+        continue;
+      }
+      arena->kod[out] = false;
+      switch (limit ? limiter->check(arena->addr[i].sin_addr.s_addr, ms) : RATE_PASS) {
+        case RATE_PASS:
+          break;
+        case RATE_KOD:
+          responder.kiss(request, reply, "RATE");
+          arena->kod[out] = true;
+          break;
+        case RATE_DROP:
+          ++ignored;
+          continue;
+      }
+
+      reply.setT0(civil(now()));
+      memcpy(arena->out[out], reply.packetAddr(), NTP::packetSize());
+      auto& txHdr = arena->tx[out].msg_hdr;
+      txHdr = {};
+      txHdr.msg_name = &arena->addr[i];
+      txHdr.msg_namelen = sizeof(arena->addr[i]);
+      txHdr.msg_iov = &arena->txIov[out];
+      txHdr.msg_iovlen = 1;
+      ++out;
+    }
+
+    unsigned sent = 0;
+    while (sent < out) {
+      const int n = sendmmsg(worker.fd, arena->tx + sent, out - sent, 0);
+      if (n <= 0) break;
+      sent += n;
+    }
+    unsigned kods = 0;
+    for (unsigned i = 0; i < sent; ++i) kods += arena->kod[i];
+    worker.served += sent - kods;
+    worker.kissed += kods;
+    worker.rejected += ignored;
+    worker.dropped += out - sent;
+  }
+  delete limiter;
+  delete arena;
+}
+
+#endif
@@ -0,0 +1,132 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "responder.h"
+#include "ratelimit.h"
+#include "leap.h"
+
+/**
+ * Nombre de paquets lus (recvmmsg) ou envoyés (sendmmsg) par appel système.
+ */
+#define SERVER_BATCH 64
+
+/**
+ * Serveur NTP multi-thread du portage Linux.
+ *
+ * Un thread par cœur, chacun épinglé sur son cœur avec sa propre socket SO_REUSEPORT : le noyau répartit
+ * les clients entre les sockets. Chaque thread vide sa socket par lots (recvmmsg), répond par lots (sendmmsg)
+ * et travaille dans sa propre zone de paquets, sans partage entre threads sur le chemin des requêtes.
+ * Chaque thread a aussi son propre limiteur de débit : SO_REUSEPORT envoie un client toujours à la même socket.
+ * Les estampilles Receive et Transmit sont données dans l'heure publiée (Leap::civil()), comme celles du
+ * répondeur de l'ESP32 : les clients des deux serveurs voient la même échelle pendant un lissage.
+ * Les requêtes signées (MAC) ou portant des champs d'extension ne sont pas servies ici : elles sont comptées
+ * comme rejetées, avec les requêtes invalides et celles que le limiteur ignore.
+ */
+class LinuxServer {
+  public:
+/**
+ * Public constructor.
+ * @param responder Modèle de réponse initial.
+ * @param threads Nombre de threads (0 = un par cœur).
+ * @param limit Active le limiteur de débit par client (à couper pour les bancs de charge en boucle locale).
+ */
+    LinuxServer(const Responder& responder, const unsigned threads = 0, const bool limit = true);
+    ~LinuxServer();
+
+/**
+ * Ouvre les sockets et démarre les threads.
+ * @param port Port UDP du serveur.
+ * @return Faux si une socket n'a pas pu être ouverte.
+ */
+    bool start(const uint16_t port);
+
+/**
+ * Arrête les threads et ferme les sockets.
+ */
+    void stop();
+
+/**
+ * Publie un nouveau modèle de réponse et l'état des secondes intercalaires ; chaque thread les recopie entre deux
+ * lots. A rappeler après chaque Leap::update() ou Leap::tick() qui change l'annonce.
+ * @param responder Répondeur à jour.
+ * @param leap Secondes intercalaires de l'heure publiée : indicateur LI annoncé et lissage des estampilles,
+ * ou nullptr pour l'heure UTC du système sans annonce.
+ */
+    void update(const Responder& responder, const Leap* leap = nullptr);
+
+/**
+ * Retourne le nombre de réponses envoyées depuis le démarrage, KoD exclus.
+ * @return Le total sur tous les threads.
+ */
+    uint64_t served() const;
+
+/**
+ * Retourne le nombre de KoD RATE envoyés depuis le démarrage.
+ * @return Le total sur tous les threads.
+ */
+    uint64_t kissed() const;
+
+/**
+ * Retourne le nombre de requêtes restées sans réponse depuis le démarrage : tronquées, signées ou avec champs
+ * d'extension, mode ou version refusés par le répondeur, ignorées par le limiteur.
+ * @return Le total sur tous les threads.
+ */
+    uint64_t rejected() const;
+
+/**
+ * Retourne le nombre de réponses préparées que sendmmsg n'a pas pu envoyer (tampon d'émission plein, erreur).
+ * @return Le total sur tous les threads.
+ */
+    uint64_t dropped() const;
+
+/**
+ * Retourne le nombre de threads du serveur.
+ * @return Le nombre de sockets/threads.
+ */
+    unsigned threads() const { return workers.size(); }
+
+  private:
+    struct Worker {
+      int fd;
+      std::thread thread;
+      alignas(64) std::atomic<uint64_t> served;
+      std::atomic<uint64_t> kissed;
+      std::atomic<uint64_t> rejected;
+      std::atomic<uint64_t> dropped;
+    };
+
+    void run(Worker& worker, const unsigned cpu);
+
+    std::vector<Worker> workers;
+    std::atomic<bool> running;
+    const bool limit;
+
+    std::mutex lock;            // protège shared et sharedLeap.
+    Responder shared;
+    std::optional<Leap> sharedLeap;
+    std::atomic<unsigned> generation;
+};
+
+#endif
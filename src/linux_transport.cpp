@@ -0,0 +1,210 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#if defined(__linux__)
+
+#include "linux_transport.h"
+
+#include <ctime>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+static uint64_t toNTP(const struct timespec& ts) {
+  return (uint64_t(ts.tv_sec) + YEAR1970) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+LinuxTransport::LinuxTransport(const bool aHardware) :
+  fd(-1),
+  hardware(aHardware),
+  stamping(STAMP_USER),
+  txDone(0),
+  txPending(false)
+{}
+
+LinuxTransport::~LinuxTransport() {
+  if (fd >= 0) close(fd);
+}
+
+bool LinuxTransport::begin(const uint16_t port) {
+  if (fd >= 0) close(fd);
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) return false;
+  const int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    fd = -1;
+    return false;
+  }
+
+  int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_OPT_TSONLY;
+  if (hardware) flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+  if (!setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags))) stamping = STAMP_TIMESTAMPING;
+  else if (!setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on))) stamping = STAMP_NS;
+  else stamping = STAMP_USER;
+  return true;
+}
+
+bool LinuxTransport::beginMulticast(const char group[], const uint16_t port) {
+  if (!begin(port)) return false;
+  struct ip_mreq mreq = {};
+  if (inet_pton(AF_INET, group, &mreq.imr_multiaddr) != 1) return false;
+  mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+  return !setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+}
+
+uint64_t LinuxTransport::now() const {
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return civil(toNTP(ts));
+}
+
+bool LinuxTransport::send(NTP& ntp, const char host[], const uint16_t port) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  struct addrinfo* res;
+  if (getaddrinfo(host, nullptr, &hints, &res)) return false;
+  const Endpoint to = { ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr, port };
+  freeaddrinfo(res);
+  return send(ntp, to);
+}
+
+bool LinuxTransport::send(NTP& ntp, const Endpoint& to) {
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = to.ip;
+  addr.sin_port = htons(to.port);
+
+  struct iovec iov = { (void*)ntp.packetAddr(), ntp.length() };
+  struct msghdr msg = {};
+  msg.msg_name = &addr;
+  msg.msg_namelen = sizeof(addr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  readTransmitStamp();   // une estampille ancienne ne doit pas passer pour celle de cet envoi.
+  stamp(ntp);  // last thing before the syscall.
+  iov.iov_len = ntp.length();
+  const bool ok = sendmsg(fd, &msg, 0) == ssize_t(ntp.length());
+  sent();
+  return ok;
+}
+
+bool LinuxTransport::send(const uint8_t data[], const size_t size, const Endpoint& to) {
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = to.ip;
+  addr.sin_port = htons(to.port);
+  readTransmitStamp();
+  const bool ok = sendto(fd, data, size, 0, (struct sockaddr*)&addr, sizeof(addr)) == ssize_t(size);
+  sent();
+  return ok;
+}
+
+void LinuxTransport::sent() {
+  txDone = now();
+  txPending = stamping == STAMP_TIMESTAMPING;
+}
+
+uint64_t LinuxTransport::lastTransmit() const {
+  if (txPending && readTransmitStamp()) txPending = false;
+  return txDone;
+}
+
+bool LinuxTransport::readTransmitStamp() const {
+  if (stamping != STAMP_TIMESTAMPING) return false;
+
+  bool found = false;
+  for (;;) {   // la file d'erreurs ne contient que des estampilles d'émission (OPT_TSONLY).
+    char control[256];
+    struct msghdr msg = {};
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) return found;
+
+    for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPING)) {
+        const auto ts = (const struct scm_timestamping*)CMSG_DATA(cmsg);
+        if (txPending && (ts->ts[0].tv_sec || ts->ts[0].tv_nsec)) {
+          txDone = civil(toNTP(ts->ts[0]));
+          found = true;
+        }
+      }
+    }
+  }
+}
+
+int LinuxTransport::receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout) {
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (;;) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    const long elapsed = (t.tv_sec - start.tv_sec) * 1000 + (t.tv_nsec - start.tv_nsec) / 1000000;
+    if (poll(&pfd, 1, elapsed < long(timeout) ? timeout - elapsed : 0) <= 0) return -1; // timedout without packet.
+    if (pfd.revents & POLLIN) break;
+    if (!(pfd.revents & POLLERR)) return -1;
+    if (readTransmitStamp()) txPending = false;   // seulement la file d'erreurs : pas de datagramme.
+  }
+
+  char control[256];
+  struct sockaddr_in addr;
+  struct iovec iov = { buffer, size };
+  struct msghdr msg = {};
+  msg.msg_name = &addr;
+  msg.msg_namelen = sizeof(addr);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  const auto nb = recvmsg(fd, &msg, MSG_DONTWAIT);
+  const uint64_t fallback = now();  // user-space fallback.
+  if (nb <= 0) return -1;
+
+  rx = 0;
+
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET) continue;
+    if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      rx = toNTP(*(const struct timespec*)CMSG_DATA(cmsg));
+    } else if (cmsg->cmsg_type == SCM_TIMESTAMPING) {
+      const auto ts = (const struct scm_timestamping*)CMSG_DATA(cmsg);
+      if (hardware && (ts->ts[2].tv_sec || ts->ts[2].tv_nsec)) rx = toNTP(ts->ts[2]);
+      else if (ts->ts[0].tv_sec || ts->ts[0].tv_nsec) rx = toNTP(ts->ts[0]);
+    }
+  }
+
+  rx = rx ? civil(rx) : fallback;
+  from.ip = addr.sin_addr.s_addr;
+  from.port = ntohs(addr.sin_port);
+  return nb;
+}
+
+#endif
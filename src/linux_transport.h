@@ -0,0 +1,79 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#if defined(__linux__)
+
+#include "transport.h"
+
+/**
+ * Transport UDP du portage Linux, estampillé par le noyau.
+ *
+ * La réception utilise SO_TIMESTAMPING (ou SO_TIMESTAMPNS à défaut) : T3 est lu dans le message de contrôle
+ * de recvmsg et non après le retour en espace utilisateur. T0 est pris juste avant sendmsg ; l'heure réelle
+ * d'émission (mode entrelacé) est relue dans la file d'erreurs de la socket (SOF_TIMESTAMPING_TX_SOFTWARE),
+ * sans attente, seulement quand lastTransmit() est appelé.
+ */
+class LinuxTransport : public Transport {
+  public:
+/**
+ * Public constructor.
+ * @param hardware Utilise les estampilles matérielles de la carte réseau si elle les fournit
+ *                 (l'horloge PHC doit alors être synchronisée sur CLOCK_REALTIME, par ex. avec phc2sys).
+ */
+    LinuxTransport(const bool hardware = false);
+    ~LinuxTransport();
+
+    bool begin(const uint16_t port) override;
+    bool beginMulticast(const char group[], const uint16_t port) override;
+    uint64_t now() const override;
+    uint64_t lastTransmit() const override;
+    bool send(NTP& ntp, const char host[], const uint16_t port) override;
+    bool send(NTP& ntp, const Endpoint& to) override;
+    bool send(const uint8_t data[], const size_t size, const Endpoint& to) override;
+
+    using Transport::receive;
+    int receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout = 0) override;
+
+/**
+ * Indique si les estampilles de réception viennent du noyau.
+ * @return Faux si aucune option d'estampillage n'a pu être activée (T3 pris en espace utilisateur).
+ */
+    bool kernelStamps() const { return stamping != STAMP_USER; }
+
+  private:
+/**
+ * Vide la file d'erreurs de la socket sans attendre ; la dernière estampille d'émission trouvée remplace txDone.
+ * @return Vrai si une estampille a été lue.
+ */
+    bool readTransmitStamp() const;
+
+/**
+ * Note l'envoi qui vient d'avoir lieu : heure de l'appel en attendant l'estampille du noyau.
+ */
+    void sent();
+
+    enum Stamping { STAMP_USER, STAMP_NS, STAMP_TIMESTAMPING };
+
+    int fd;
+    bool hardware;
+    Stamping stamping;
+    mutable uint64_t txDone;
+    mutable bool txPending;   // estampille d'émission du noyau pas encore lue.
+};
+
+#endif
@@ -16,18 +16,19 @@
 
 #include "ntp.h"
 
+#include <cstddef>
 #include <cstdio>
 #include <cmath>
 
 #define MS1900(A, B) ( ((((A[0] * 256UL + A[1]) * 256UL + A[2]) * 256UL + A[3]) * 1000000ULL) + (((((B[0] * 256UL + B[1]) * 256UL + B[2]) * 256UL + B[3]) * 1000000ULL) >> 32) )
-#define MAXSTRAT 16
 
-NTP::NTP() : packet( (ntp_packet){ 0, 0, 0, 0, 0, 0, "", 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0 } ) {}
+NTP::NTP() : packet( (ntp_packet){ 0, 0, 0, 0, 0, 0, "", 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0 } ), trailer(), trailerLen(0), t3(0) {
+  static_assert(offsetof(NTP, trailer) == offsetof(NTP, packet) + sizeof(ntp_packet), "trailer must follow packet");
+}
 
 NTP NTP::makeNTP(const NtpMode mode, const byte version) {
   NTP result;
-  // result.packet.li_vn_mode = (version % 8) << 3 + (mode % 8);
-  result.packet.li_vn_mode = 0b00011011;
+  result.setHeader(0, version, mode);
   result.packet.stratum = MAXSTRAT;
   result.packet.precision = -10;
   return result;
@@ -67,6 +68,116 @@ double NTP::getPrecision() const {
   return pow(double(2), double(packet.precision));
 }
 
+uint8_t NTP::getStratum() const {
+  return packet.stratum;
+}
+
+byte NTP::getLeap() const {
+  return packet.li_vn_mode >> 6;
+}
+
+/**
+ * Convertit un champ NTP court (16.16, ordre réseau) en microsecondes.
+ */
+static uint32_t shortToMicros(const int32_t& field) {
+  const uint8_t* const p = (const uint8_t*)&field;
+  const uint32_t v = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+  return (uint64_t(v) * 1000000ULL) >> 16;
+}
+
+uint32_t NTP::getRootDelay() const {
+  return shortToMicros(packet.rootDelay);
+}
+
+uint32_t NTP::getRootDispersion() const {
+  return shortToMicros(packet.rootDispersion);
+}
+
+/**
+ * Convertit des microsecondes en champ NTP court (16.16, ordre réseau), saturé.
+ */
+static void microsToShort(const uint32_t us, int32_t& field) {
+  const uint64_t v64 = (uint64_t(us) << 16) / 1000000ULL;
+  const uint32_t v = v64 > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : uint32_t(v64);
+  uint8_t* const p = (uint8_t*)&field;
+  p[0] = v >> 24;
+  p[1] = (v >> 16) & 0xFF;
+  p[2] = (v >> 8) & 0xFF;
+  p[3] = v & 0xFF;
+}
+
+void NTP::setRoot(const uint32_t delay, const uint32_t dispersion) {
+  microsToShort(delay, packet.rootDelay);
+  microsToShort(dispersion, packet.rootDispersion);
+}
+
+uint32_t NTP::getRootDistance() const {
+  return (uint64_t(getRootDelay()) + getRTT()) / 2 + getRootDispersion();
+}
+
+uint64_t NTP::getRefTime() const {
+  return MS1900(packet.refTm_s, packet.refTm_f);
+}
+
+NtpCheck NTP::check() const {
+  const auto version = getVersion();
+  if (((version != 3) && (version != 4)) || (getMode() != NTPMODE_SERVER)) return NTP_CHECK_FORMAT;
+  if (!packet.stratum) return NTP_CHECK_KISS;
+  if ((getLeap() == 3) || (packet.stratum >= MAXSTRAT)) return NTP_CHECK_UNSYNC;
+
+  const auto t1 = getT1();
+  const auto t2 = getT2();
+  const auto ref = getRefTime();
+  if (!t1 || !t2 || (t2 < t1) || (getT3() < getT0()) || !ref || (ref > t2)) return NTP_CHECK_INVALID;
+
+  if (getRootDistance() >= MAXDIST) return NTP_CHECK_DISTANCE;
+  return NTP_CHECK_OK;
+}
+
+void NTP::setHeader(const byte li, const byte version, const NtpMode mode) {
+  packet.li_vn_mode = ((li & 0b011) << 6) | ((version & 0b0111) << 3) | (mode & 0b0111);
+}
+
+void NTP::setClock(const uint8_t stratum, const int8_t poll, const int8_t precision, const char refId[4]) {
+  packet.stratum = stratum;
+  packet.poll = poll;
+  packet.precision = precision;
+  memcpy(packet.refId, refId, 4);
+}
+
+uint32_t NTP::getKeyId() const {
+  if (trailerLen < 4) return 0;
+  return (uint32_t(trailer[0]) << 24) | (uint32_t(trailer[1]) << 16) | (uint32_t(trailer[2]) << 8) | trailer[3];
+}
+
+void NTP::setPacket(const uint8_t buffer[], const size_t len) {
+  setPacket(buffer);
+  const auto mac = len - sizeof(ntp_packet);
+  if ((len > sizeof(ntp_packet)) && (mac > 4) && (mac <= sizeof(trailer))) {  // RFC 7822 : un MAC seul fait au plus 24 octets.
+    memcpy(trailer, buffer + sizeof(ntp_packet), mac);
+    trailerLen = mac;
+  }
+}
+
+void NTP::setKeyId(const uint32_t keyId) {
+  if (!keyId) {
+    trailerLen = 0;
+    return;
+  }
+  trailer[0] = keyId >> 24;
+  trailer[1] = (keyId >> 16) & 0xFF;
+  trailer[2] = (keyId >> 8) & 0xFF;
+  trailer[3] = keyId & 0xFF;
+  trailerLen = 4;
+}
+
+void NTP::setMac(const uint8_t mac[], const byte len) {
+  if (trailerLen < 4) return;
+  const byte n = len > NTP_MAX_MAC ? NTP_MAX_MAC : len;
+  memcpy(trailer + 4, mac, n);
+  trailerLen = 4 + n;
+}
+
 const char* NTP::getId() const {
   static char id[30];
   return packet.refId;
@@ -18,7 +18,11 @@
 
 #include <cstdint>
 #include <cstring>
+#if defined(__linux__)
+typedef uint8_t byte;
+#else
 #include <arduino.h>
+#endif
 
 // #define byte unsigned char
 
@@ -27,6 +31,31 @@
  */
  #define YEAR1970 2208988800
 
+/**
+ * Strate maximale (horloge non synchronisée).
+ */
+#define MAXSTRAT 16
+
+/**
+ * Taille maximale du MAC d'authentification (SHA-1 : 20 octets, AES-CMAC : 16 octets).
+ */
+#define NTP_MAX_MAC 20
+
+/**
+ * Taille maximale d'un datagramme NTP reçu ou construit, champs d'extension compris.
+ */
+#define NTP_MAX_PACKET 1024
+
+/**
+ * Distance de synchronisation maximale acceptée d'un serveur, en microsecondes (RFC 5905 MAXDIST).
+ */
+#define MAXDIST 1500000
+
+/**
+ * Tolérance de fréquence d'une horloge, en ppm (µs/s) : croissance de la dispersion (RFC 5905 PHI).
+ */
+#define PHI 15
+
 /**
  * Listes des modes NTP 
  *  0 reserved
@@ -40,6 +69,17 @@
  */
  enum NtpMode { NTPMODE_RESERVED = 0, NTPMODE_SYMMETRIC_ACTIVE = 1, NTPMODE_SYMMETRIC_PASSIVE = 2, NTPMODE_CLIENT = 3, NTPMODE_SERVER = 4, NTPMODE_BROADCAST = 5, NTPMODE_CONTROL_MESSAGE = 6, NTPMODE_PRIVATE_USE = 7 }; 
 
+/**
+ * Résultat des tests d'une réponse serveur (RFC 5905 §8).
+ *  NTP_CHECK_OK       réponse utilisable
+ *  NTP_CHECK_FORMAT   version autre que 3 ou 4, ou mode autre que serveur
+ *  NTP_CHECK_KISS     Kiss-o'-Death (strate 0), le code est dans getId()
+ *  NTP_CHECK_UNSYNC   serveur non synchronisé (LI = 3 ou strate 16)
+ *  NTP_CHECK_INVALID  horodatages absents ou incohérents
+ *  NTP_CHECK_DISTANCE distance de synchronisation supérieure à MAXDIST
+ */
+enum NtpCheck { NTP_CHECK_OK, NTP_CHECK_FORMAT, NTP_CHECK_KISS, NTP_CHECK_UNSYNC, NTP_CHECK_INVALID, NTP_CHECK_DISTANCE };
+
 /**
  * La classe NTP encapsule les fonctionnalités liées à la communication avec le serveur NTP.
  * @see https://fr.wikipedia.org/wiki/Network_Time_Protocol
@@ -48,7 +88,7 @@
 class NTP {
   public:
 /**
-  * Forge un packet NTP V3 client vide.
+  * Forge un packet NTP vide.
   * @param mode Valeur du mode.
   * @param version Valeur de la version du protocole, par défaut 4.
   * @return Une instance NTP.
@@ -86,6 +126,36 @@ class NTP {
  */
     byte getVersion() const;
 
+/**
+ * Retourne l'indicateur de seconde intercalaire (LI).
+ * @return 0 rien, 1 dernière minute de 61 s, 2 dernière minute de 59 s, 3 horloge non synchronisée.
+ */
+    byte getLeap() const;
+
+/**
+ * Retourne le délai aller/retour jusqu'à la référence primaire annoncé par le serveur.
+ * @return Un temps en microsecondes.
+ */
+    uint32_t getRootDelay() const;
+
+/**
+ * Retourne la dispersion jusqu'à la référence primaire annoncée par le serveur.
+ * @return Un temps en microsecondes.
+ */
+    uint32_t getRootDispersion() const;
+
+/**
+ * Retourne l'heure de la dernière synchronisation du serveur.
+ * @return Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    uint64_t getRefTime() const;
+
+/**
+ * Retourne la distance de synchronisation à la référence primaire : (délai racine + RTT) / 2 + dispersion racine.
+ * @return Un temps en microsecondes (T3 doit être positionné).
+ */
+    uint32_t getRootDistance() const;
+
 /**
  * Retourne le temps entre 2 demandes acceptable par le serveur.
  * @return Un temps en secondes.
@@ -147,11 +217,118 @@ class NTP {
     unsigned long getRTT() const;
 
 
+/**
+ * Retourne le niveau de strate du serveur.
+ * @return Un entier entre 0 (KoD) et 16 (non synchronisé).
+ */
+    uint8_t getStratum() const;
+
+/**
+ * Tests d'une réponse serveur, une fois l'origine vérifiée (T3 doit être positionné).
+ * @return NTP_CHECK_OK si la réponse est utilisable, sinon la raison du rejet.
+ */
+    NtpCheck check() const;
+
+/**
+ * Retourne la taille du paquet à émettre, MAC compris.
+ * @return la taille en octets.
+ */
+    size_t length() const;
+
+/**
+ * Retourne l'identifiant de clé du MAC (RFC 5905 §7.3).
+ * @return L'identifiant, 0 si le paquet n'est pas authentifié.
+ */
+    uint32_t getKeyId() const;
+
+/**
+ * Retourne le MAC reçu ou calculé.
+ * @return Un pointeur sur le condensat (getMacLength() octets).
+ */
+    const uint8_t* getMac() const;
+    byte getMacLength() const;
+
     void setPacket(const uint8_t buffer[]);
+
+/**
+ * Recopie un datagramme reçu : l'entête, et le MAC s'il y en a un.
+ * @param buffer Le datagramme.
+ * @param len Sa taille.
+ */
+    void setPacket(const uint8_t buffer[], const size_t len);
+
+/**
+ * Demande l'authentification du paquet ; le MAC est calculé à l'émission (Keyring::sign).
+ * @param keyId Identifiant de la clé, 0 pour ne pas authentifier.
+ */
+    void setKeyId(const uint32_t keyId);
+
+/**
+ * Ajoute le MAC après l'identifiant de clé.
+ * @param mac Le condensat.
+ * @param len Sa taille (NTP_MAX_MAC au plus).
+ */
+    void setMac(const uint8_t mac[], const byte len);
     void setT0(const uint64_t& tx);
+    void setT1(const uint64_t& rx);
     void setT3(const uint64_t& rx);
 
+/**
+ * Positionne les champs LI, version et mode de l'entête.
+ * @param li Indicateur de seconde intercalaire (0..3).
+ * @param version Version du protocole.
+ * @param mode Mode NTP.
+ */
+    void setHeader(const byte li, const byte version, const NtpMode mode);
+
+/**
+ * Positionne les champs décrivant l'horloge de l'émetteur (mode serveur).
+ * @param stratum Niveau de strate.
+ * @param poll Exposant de polling (2^n s).
+ * @param precision Exposant de précision (2^n s).
+ * @param refId Identifiant de la référence (IP du serveur amont).
+ */
+    void setClock(const uint8_t stratum, const int8_t poll, const int8_t precision, const char refId[4]);
+
+/**
+ * Positionne le délai et la dispersion jusqu'à la référence primaire (mode serveur).
+ * @param delay Délai racine en microsecondes.
+ * @param dispersion Dispersion racine en microsecondes.
+ */
+    void setRoot(const uint32_t delay, const uint32_t dispersion);
+
+/**
+ * Positionne l'heure de la dernière synchronisation de l'horloge locale.
+ * @param ref Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    void setRefTime(const uint64_t& ref);
+
+/**
+ * Recopie bit à bit le champ Transmit d'une requête dans le champ Origin (mode serveur).
+ * @param request La requête du client.
+ */
+    void setOrigin(const NTP& request);
+
+/**
+ * Recopie bit à bit le champ Receive d'un paquet dans le champ Origin (mode entrelacé).
+ * @param other Paquet dont le champ Receive est recopié.
+ */
+    void setOriginFromReceive(const NTP& other);
+
+/**
+ * Réécrit le champ Origin (mode entrelacé côté client : T0 précis de l'envoi précédent).
+ * @param org Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    void setOriginTime(const uint64_t& org);
+
   private:
+/**
+ * Encode un temps en microsecondes dans un horodatage NTP 32.32.
+ * @param t Le temps en microsecondes depuis le 1er janvier 1900.
+ * @param s Partie secondes.
+ * @param f Partie fraction.
+ */
+    static void encode(const uint64_t& t, uint8_t s[4], uint8_t f[4]);
 
     struct ntp_packet {
       uint8_t li_vn_mode;      // Eight bits. li, vn, and mode (Flags  MSB[LI:2 VN:3 Mode:3]LSB   LI=0, VN=3 mode=3)
@@ -178,6 +355,9 @@ class NTP {
 
     } packet;                 // Total: 384 bits or 48 bytes.
 
+    uint8_t  trailer[4 + NTP_MAX_MAC];  // Key ID + MAC, contigus à packet pour l'émission.
+    uint8_t  trailerLen;
+
     uint64_t t3;
 
 /**
@@ -189,32 +369,75 @@ class NTP {
 
 inline void NTP::setPacket(const uint8_t buffer[]) {
   memcpy(&packet, buffer, sizeof(ntp_packet));
+  trailerLen = 0;
 }
 
-/**
- * Set Transmit Timestamp before send.
- * @param tx Transmit Timestamp in µsec since 1/1/1900.
- * @warning T0 must be write in Transmit Timestamp before sending to server.
- */
-inline void NTP::setT0(const uint64_t& tx) {
-  const uint32_t d = tx / 1000000;      // div
-  const uint64_t m = tx - d * 1000000;  // mod
+inline size_t NTP::length() const {
+  return sizeof(ntp_packet) + trailerLen;
+}
+
+inline const uint8_t* NTP::getMac() const {
+  return trailer + 4;
+}
+
+inline byte NTP::getMacLength() const {
+  return trailerLen > 4 ? trailerLen - 4 : 0;
+}
+
+inline void NTP::encode(const uint64_t& t, uint8_t s[4], uint8_t f[4]) {
+  const uint32_t d = t / 1000000;      // div
+  const uint64_t m = t - d * 1000000ULL;  // mod
 
   uint32_t sec = d;
-  packet.txTm_s[3] = sec & 0xFF;
+  s[3] = sec & 0xFF;
   sec >>= 8;
-  packet.txTm_s[2] = sec & 0xFF;
+  s[2] = sec & 0xFF;
   sec >>= 8;
-  packet.txTm_s[1] = sec & 0xFF;
-  packet.txTm_s[0] = sec >> 8;
+  s[1] = sec & 0xFF;
+  s[0] = sec >> 8;
 
   uint32_t micros = (m << 32) / 1000000;
-  packet.txTm_f[3] = micros & 0xFF;
+  f[3] = micros & 0xFF;
   micros >>= 8;
-  packet.txTm_f[2] = micros & 0xFF;
+  f[2] = micros & 0xFF;
   micros >>= 8;
-  packet.txTm_f[1] = micros & 0xFF;
-  packet.txTm_f[0] = micros >> 8;
+  f[1] = micros & 0xFF;
+  f[0] = micros >> 8;
+}
+
+/**
+ * Set Transmit Timestamp before send.
+ * @param tx Transmit Timestamp in µsec since 1/1/1900.
+ * @warning T0 must be write in Transmit Timestamp before sending to server.
+ */
+inline void NTP::setT0(const uint64_t& tx) {
+  encode(tx, packet.txTm_s, packet.txTm_f);
+}
+
+/**
+ * Set Receive Timestamp (server mode).
+ * @param rx Receive Timestamp of the request in µsec since 1/1/1900.
+ */
+inline void NTP::setT1(const uint64_t& rx) {
+  encode(rx, packet.rxTm_s, packet.rxTm_f);
+}
+
+inline void NTP::setRefTime(const uint64_t& ref) {
+  encode(ref, packet.refTm_s, packet.refTm_f);
+}
+
+inline void NTP::setOrigin(const NTP& request) {
+  memcpy(packet.origTm_s, request.packet.txTm_s, 4);
+  memcpy(packet.origTm_f, request.packet.txTm_f, 4);
+}
+
+inline void NTP::setOriginFromReceive(const NTP& other) {
+  memcpy(packet.origTm_s, other.packet.rxTm_s, 4);
+  memcpy(packet.origTm_f, other.packet.rxTm_f, 4);
+}
+
+inline void NTP::setOriginTime(const uint64_t& org) {
+  encode(org, packet.origTm_s, packet.origTm_f);
 }
 
 inline void NTP::setT3(const uint64_t& rx) {
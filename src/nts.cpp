@@ -0,0 +1,349 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "nts.h"
+#include "extension.h"
+
+#include <mbedtls/cmac.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#else
+#include <esp_random.h>
+#endif
+
+// Enregistrements NTS-KE (RFC 8915 §4).
+#define KE_END 0
+#define KE_NEXT_PROTOCOL 1
+#define KE_ERROR 2
+#define KE_WARNING 3
+#define KE_AEAD 4
+#define KE_COOKIE 5
+#define KE_SERVER 6
+#define KE_PORT 7
+#define KE_CRITICAL 0x8000
+
+#define PROTOCOL_NTPV4 0
+#define AEAD_AES_SIV_CMAC_256 15
+#define EXPORTER_LABEL "EXPORTER-network-time-security"
+
+// Champs d'extension NTP (RFC 8915 §5.7).
+#define EF_UNIQUE_ID 0x0104
+#define EF_COOKIE 0x0204
+#define EF_PLACEHOLDER 0x0304
+#define EF_AUTHENTICATOR 0x0404
+
+#define SIV_BLOCK 16
+#define NONCE_SIZE 16
+
+static void fillRandom(uint8_t data[], const size_t len) {
+#if defined(__linux__)
+  size_t done = 0;
+  while (done < len) {
+    const ssize_t n = getrandom(data + done, len - done, 0);
+    if (n > 0) done += n;
+  }
+#else
+  esp_fill_random(data, len);
+#endif
+}
+
+static inline uint16_t get16(const uint8_t p[]) { return (p[0] << 8) | p[1]; }
+static inline void put16(uint8_t p[], const uint16_t v) { p[0] = v >> 8; p[1] = v; }
+static inline size_t pad4(const size_t n) { return (n + 3) & ~size_t(3); }
+
+/**
+ * Doublement dans GF(2^128) (RFC 5297 §2.3).
+ */
+static void dbl(uint8_t d[SIV_BLOCK]) {
+  const uint8_t carry = d[0] & 0x80;
+  for (byte i = 0; i < SIV_BLOCK - 1; ++i) d[i] = (d[i] << 1) | (d[i + 1] >> 7);
+  d[SIV_BLOCK - 1] = (d[SIV_BLOCK - 1] << 1) ^ (carry ? 0x87 : 0);
+}
+
+AesSiv::AesSiv() {
+  mbedtls_cipher_init(&k1);
+  mbedtls_aes_init(&k2);
+}
+
+AesSiv::~AesSiv() {
+  mbedtls_cipher_free(&k1);
+  mbedtls_aes_free(&k2);
+}
+
+bool AesSiv::setKey(const uint8_t key[32]) {
+  mbedtls_cipher_free(&k1);
+  mbedtls_cipher_init(&k1);
+  return !mbedtls_cipher_setup(&k1, mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB))
+      && !mbedtls_cipher_cmac_starts(&k1, key, 128)
+      && !mbedtls_aes_setkey_enc(&k2, key + 16, 128);
+}
+
+bool AesSiv::cmac(const uint8_t data[], const size_t len, uint8_t out[16]) {
+  static const uint8_t empty = 0;   // mbedtls refuse un pointeur nul, même pour 0 octet (données associées vides).
+  return !mbedtls_cipher_cmac_reset(&k1)
+      && !mbedtls_cipher_cmac_update(&k1, len ? data : &empty, len)
+      && !mbedtls_cipher_cmac_finish(&k1, out);
+}
+
+bool AesSiv::s2v(const uint8_t* const parts[], const size_t lens[], const byte count, uint8_t v[16]) {
+  static const uint8_t zero[SIV_BLOCK] = { 0 };
+  uint8_t d[SIV_BLOCK];
+  uint8_t t[SIV_BLOCK];
+  if (!cmac(zero, SIV_BLOCK, d)) return false;
+
+  for (byte i = 0; i + 1 < count; ++i) {
+    if (!cmac(parts[i], lens[i], t)) return false;
+    dbl(d);
+    for (byte j = 0; j < SIV_BLOCK; ++j) d[j] ^= t[j];
+  }
+
+  const uint8_t* const last = parts[count - 1];
+  const size_t len = lens[count - 1];
+  if (mbedtls_cipher_cmac_reset(&k1)) return false;
+  if (len >= SIV_BLOCK) {   // T = P xorend D
+    for (byte j = 0; j < SIV_BLOCK; ++j) t[j] = last[len - SIV_BLOCK + j] ^ d[j];
+    if (mbedtls_cipher_cmac_update(&k1, last, len - SIV_BLOCK)) return false;
+  } else {                  // T = dbl(D) xor pad(P)
+    dbl(d);
+    memset(t, 0, SIV_BLOCK);
+    if (len) memcpy(t, last, len);
+    t[len] = 0x80;
+    for (byte j = 0; j < SIV_BLOCK; ++j) t[j] ^= d[j];
+  }
+  return !mbedtls_cipher_cmac_update(&k1, t, SIV_BLOCK) && !mbedtls_cipher_cmac_finish(&k1, v);
+}
+
+bool AesSiv::ctr(const uint8_t v[16], const uint8_t in[], const size_t len, uint8_t out[]) {
+  if (!len) return true;
+  uint8_t q[SIV_BLOCK];
+  uint8_t stream[SIV_BLOCK];
+  size_t off = 0;
+  memcpy(q, v, SIV_BLOCK);
+  q[8] &= 0x7F;   // bits 63 et 31 à zéro (RFC 5297 §2.5).
+  q[12] &= 0x7F;
+  return !mbedtls_aes_crypt_ctr(&k2, len, &off, q, stream, in, out);
+}
+
+bool AesSiv::seal(const uint8_t nonce[], const size_t nonceLen, const uint8_t ad[], const size_t adLen,
+                  const uint8_t plain[], const size_t len, uint8_t out[]) {
+  const uint8_t* const parts[] = { ad, nonce, plain };
+  const size_t lens[] = { adLen, nonceLen, len };
+  return s2v(parts, lens, 3, out) && ctr(out, plain, len, out + SIV_BLOCK);
+}
+
+bool AesSiv::open(const uint8_t nonce[], const size_t nonceLen, const uint8_t ad[], const size_t adLen,
+                  const uint8_t in[], const size_t len, uint8_t plain[]) {
+  if (len < SIV_BLOCK) return false;
+  if (!ctr(in, in + SIV_BLOCK, len - SIV_BLOCK, plain)) return false;
+
+  const uint8_t* const parts[] = { ad, nonce, plain };
+  const size_t lens[] = { adLen, nonceLen, len - SIV_BLOCK };
+  uint8_t v[SIV_BLOCK];
+  if (!s2v(parts, lens, 3, v)) return false;
+
+  uint8_t diff = 0;  // comparaison en temps constant.
+  for (byte i = 0; i < SIV_BLOCK; ++i) diff |= v[i] ^ in[i];
+  return !diff;
+}
+
+CookieJar::CookieJar() :
+  head(0),
+  count(0)
+{
+}
+
+bool CookieJar::push(const uint8_t cookie[], const size_t len) {
+  if (!len || (len > NTS_MAX_COOKIE)) return false;
+  if (count == NTS_COOKIES) {   // bocal plein : le plus ancien est remplacé.
+    head = (head + 1) % NTS_COOKIES;
+    --count;
+  }
+  const byte slot = (head + count) % NTS_COOKIES;
+  memcpy(cookies[slot], cookie, len);
+  lens[slot] = len;
+  ++count;
+  return true;
+}
+
+const uint8_t* CookieJar::pop(size_t& len) {
+  if (!count) return nullptr;
+  const byte slot = head;
+  head = (head + 1) % NTS_COOKIES;
+  --count;
+  len = lens[slot];
+  return cookies[slot];
+}
+
+NtsClient::NtsClient() :
+  port(123),
+  ready(false)
+{
+  server[0] = 0;
+  memset(uid, 0, sizeof(uid));
+}
+
+bool NtsClient::record(const uint16_t type, const bool critical, const uint8_t body[], const size_t len, NtsKeChannel& channel) {
+  uint8_t head[4];
+  put16(head, type | (critical ? KE_CRITICAL : 0));
+  put16(head + 2, len);
+  return channel.write(head, 4) && (!len || channel.write(body, len));
+}
+
+bool NtsClient::exchange(NtsKeChannel& channel) {
+  ready = false;
+  jar.clear();
+  server[0] = 0;
+  port = 123;
+
+  uint8_t body[NTS_MAX_COOKIE];
+  put16(body, PROTOCOL_NTPV4);
+  put16(body + 2, AEAD_AES_SIV_CMAC_256);
+  if (!record(KE_NEXT_PROTOCOL, true, body, 2, channel)
+   || !record(KE_AEAD, true, body + 2, 2, channel)
+   || !record(KE_END, true, nullptr, 0, channel)) return false;
+
+  bool protocol = false;
+  bool aead = false;
+  for (;;) {
+    uint8_t head[4];
+    if (!channel.read(head, 4)) return false;
+    const uint16_t type = get16(head) & ~KE_CRITICAL;
+    const bool critical = get16(head) & KE_CRITICAL;
+    const size_t len = get16(head + 2);
+
+    if (len > sizeof(body)) {   // trop long pour nous : lu et ignoré (sauf s'il est critique).
+      if (critical) return false;
+      for (size_t n = len; n; ) {
+        const size_t chunk = n < sizeof(body) ? n : sizeof(body);
+        if (!channel.read(body, chunk)) return false;
+        n -= chunk;
+      }
+      continue;
+    }
+    if (len && !channel.read(body, len)) return false;
+
+    switch (type) {
+      case KE_END:
+        break;
+      case KE_NEXT_PROTOCOL:
+        protocol = (len == 2) && (get16(body) == PROTOCOL_NTPV4);
+        continue;
+      case KE_AEAD:
+        aead = (len == 2) && (get16(body) == AEAD_AES_SIV_CMAC_256);
+        continue;
+      case KE_COOKIE:
+        jar.push(body, len);
+        continue;
+      case KE_SERVER:
+        if (len >= sizeof(server)) return false;
+        memcpy(server, body, len);
+        server[len] = 0;
+        continue;
+      case KE_PORT:
+        if (len != 2) return false;
+        port = get16(body);
+        continue;
+      case KE_ERROR:
+        return false;
+      case KE_WARNING:
+        continue;
+      default:
+        if (critical) return false;
+        continue;
+    }
+    break;
+  }
+  if (!protocol || !aead || !jar.size()) return false;
+
+  uint8_t context[5] = { 0, PROTOCOL_NTPV4, 0, AEAD_AES_SIV_CMAC_256, 0x00 };
+  uint8_t key[32];
+  if (!channel.exportKey(EXPORTER_LABEL, context, sizeof(context), key, sizeof(key)) || !c2s.setKey(key)) return false;
+  context[4] = 0x01;
+  if (!channel.exportKey(EXPORTER_LABEL, context, sizeof(context), key, sizeof(key)) || !s2c.setKey(key)) return false;
+  memset(key, 0, sizeof(key));
+
+  ready = true;
+  return true;
+}
+
+size_t NtsClient::prepare(const NTP& ntp, uint8_t out[NTP_MAX_PACKET]) {
+  if (!ready) return 0;
+  size_t len;
+  const uint8_t* const cookie = jar.pop(len);
+  if (!cookie) return 0;
+
+  ExtensionBuilder builder(out, NTP_MAX_PACKET);
+  builder.header(ntp);
+  fillRandom(uid, sizeof(uid));
+  builder.add(EF_UNIQUE_ID, uid, sizeof(uid));
+  builder.add(EF_COOKIE, cookie, len);
+
+  // Un emplacement par cookie manquant, pour que la réponse remplisse de nouveau le bocal.
+  const size_t authSize = 4 + 4 + NONCE_SIZE + SIV_BLOCK;
+  for (byte missing = NTS_COOKIES - 1 - jar.size(); missing && (builder.size() + 4 + pad4(len) + authSize <= NTP_MAX_PACKET); --missing) {
+    builder.reserve(EF_PLACEHOLDER, len);
+  }
+
+  // Authentificateur : texte clair vide, l'étiquette S2V couvre tout ce qui précède.
+  const size_t aad = builder.size();
+  uint8_t* const auth = builder.reserve(EF_AUTHENTICATOR, 4 + NONCE_SIZE + SIV_BLOCK);
+  if (!auth) return 0;
+  uint8_t* const nonce = auth + 4;
+  fillRandom(nonce, NONCE_SIZE);
+  put16(auth, NONCE_SIZE);
+  put16(auth + 2, SIV_BLOCK);
+  if (!c2s.seal(nonce, NONCE_SIZE, out, aad, nullptr, 0, nonce + NONCE_SIZE)) return 0;
+  return builder.finish();
+}
+
+bool NtsClient::verify(const uint8_t packet[], const size_t len) {
+  if (!ready || (len <= NTP::packetSize())) return false;
+
+  bool unique = false;
+  ExtensionIterator it(packet, len);
+  for (ExtensionField field; it.next(field); ) {
+    if (field.type == EF_UNIQUE_ID) {
+      unique = (field.valueLength() == sizeof(uid)) && !memcmp(field.value, uid, sizeof(uid));
+    } else if (field.type == EF_AUTHENTICATOR) {
+      if (!unique || (field.valueLength() < 4)) return false;
+      const size_t nonceLen = get16(field.value);
+      const size_t cipherLen = get16(field.value + 2);
+      if (4 + pad4(nonceLen) + pad4(cipherLen) > field.valueLength()) return false;
+      const uint8_t* const nonce = field.value + 4;
+      const uint8_t* const cipher = nonce + pad4(nonceLen);
+
+      uint8_t plain[NTP_MAX_PACKET];
+      const size_t aad = field.value - 4 - packet;
+      if ((cipherLen < SIV_BLOCK) || !s2c.open(nonce, nonceLen, packet, aad, cipher, cipherLen, plain)) return false;
+
+      // Champs chiffrés : les nouveaux cookies.
+      ExtensionIterator inner(plain, cipherLen - SIV_BLOCK, 0, false);
+      for (ExtensionField f; inner.next(f); ) {
+        if (f.type == EF_COOKIE) jar.push(f.value, f.valueLength());
+      }
+      return true;    // ce qui suit l'authentificateur n'est pas authentifié et n'est pas lu.
+    }
+  }
+
+  // Kiss-o'-Death NTSN : le serveur ne reconnaît plus nos cookies, il faut refaire l'établissement de clés.
+  if (unique && !packet[1] && !memcmp(packet + 12, "NTSN", 4)) {
+    jar.clear();
+    ready = false;
+  }
+  return false;
+}
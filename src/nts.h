@@ -0,0 +1,174 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <mbedtls/aes.h>
+#include <mbedtls/cipher.h>
+#include "ntp.h"
+
+/**
+ * Taille du bocal à cookies (RFC 8915 : le client en garde 8) et taille maximale d'un cookie.
+ */
+#define NTS_COOKIES 8
+#define NTS_MAX_COOKIE 256
+
+/**
+ * AEAD_AES_SIV_CMAC_256 (RFC 5297), seul algorithme obligatoire de NTS.
+ * Les clés sont étendues une fois à l'installation : le chemin de chaque poll ne refait aucune préparation.
+ */
+class AesSiv {
+  public:
+    AesSiv();
+    ~AesSiv();
+
+/**
+ * Installe la clé.
+ * @param key 32 octets : K1 (S2V/CMAC) puis K2 (CTR).
+ * @return Faux en cas d'erreur de la bibliothèque.
+ */
+    bool setKey(const uint8_t key[32]);
+
+/**
+ * Chiffre et authentifie.
+ * @param nonce Nonce.
+ * @param nonceLen Taille du nonce.
+ * @param ad Données associées (authentifiées, non chiffrées).
+ * @param adLen Taille des données associées.
+ * @param plain Texte clair.
+ * @param len Taille du texte clair.
+ * @param out Reçoit l'étiquette (16 octets) suivie du chiffré (len octets).
+ * @return Vrai si le chiffrement a réussi.
+ */
+    bool seal(const uint8_t nonce[], const size_t nonceLen, const uint8_t ad[], const size_t adLen,
+              const uint8_t plain[], const size_t len, uint8_t out[]);
+
+/**
+ * Déchiffre et vérifie.
+ * @param nonce Nonce.
+ * @param nonceLen Taille du nonce.
+ * @param ad Données associées.
+ * @param adLen Taille des données associées.
+ * @param in Etiquette (16 octets) suivie du chiffré.
+ * @param len Taille totale de in (16 au moins).
+ * @param plain Reçoit le texte clair (len - 16 octets).
+ * @return Vrai si l'étiquette est correcte.
+ */
+    bool open(const uint8_t nonce[], const size_t nonceLen, const uint8_t ad[], const size_t adLen,
+              const uint8_t in[], const size_t len, uint8_t plain[]);
+
+  private:
+    bool cmac(const uint8_t data[], const size_t len, uint8_t out[16]);
+    bool s2v(const uint8_t* const parts[], const size_t lens[], const byte count, uint8_t v[16]);
+    bool ctr(const uint8_t v[16], const uint8_t in[], const size_t len, uint8_t out[]);
+
+    mbedtls_cipher_context_t k1;   // CMAC.
+    mbedtls_aes_context      k2;   // CTR.
+};
+
+/**
+ * Bocal à cookies NTS : file de taille fixe, un cookie consommé par requête, ceux des réponses y sont rangés.
+ */
+class CookieJar {
+  public:
+    CookieJar();
+
+    bool push(const uint8_t cookie[], const size_t len);
+
+/**
+ * Retire le plus ancien cookie.
+ * @param len Reçoit sa taille.
+ * @return Un pointeur sur le cookie, valide jusqu'au prochain push(), ou nullptr si le bocal est vide.
+ */
+    const uint8_t* pop(size_t& len);
+
+    byte size() const { return count; }
+    void clear() { count = 0; }
+
+  private:
+    uint8_t  cookies[NTS_COOKIES][NTS_MAX_COOKIE];
+    uint16_t lens[NTS_COOKIES];
+    byte     head;
+    byte     count;
+};
+
+/**
+ * Canal de l'établissement de clés NTS-KE (TLS 1.3, ALPN "ntske/1").
+ * L'implémentation fournit le flux et l'exportateur de clés TLS (RFC 8446 §7.5).
+ */
+class NtsKeChannel {
+  public:
+    virtual ~NtsKeChannel() {}
+    virtual bool write(const uint8_t data[], const size_t len) = 0;
+
+/**
+ * Lit exactement len octets.
+ */
+    virtual bool read(uint8_t data[], const size_t len) = 0;
+
+    virtual bool exportKey(const char label[], const uint8_t context[], const size_t contextLen, uint8_t out[], const size_t len) = 0;
+};
+
+/**
+ * Client NTS (RFC 8915) : établissement de clés, gestion des cookies et champs d'extension authentifiés.
+ *
+ * Les cookies sont obtenus à l'établissement puis renouvelés par chaque réponse : le client ne refait un
+ * NTS-KE que si le bocal se vide. Par poll, le coût cryptographique est un seal (étiquette seule) et un open.
+ */
+class NtsClient {
+  public:
+    NtsClient();
+
+/**
+ * Etablissement de clés : négocie NTPv4 et AEAD_AES_SIV_CMAC_256, récupère cookies, serveur et port.
+ * @param channel Canal NTS-KE ouvert.
+ * @return Vrai si la négociation a réussi et qu'au moins un cookie a été reçu.
+ */
+    bool exchange(NtsKeChannel& channel);
+
+/**
+ * Construit une requête NTS : entête, Unique Identifier, cookie, emplacements pour les cookies manquants et
+ * authentificateur.
+ * @param ntp Entête déjà estampillé (champ Transmit).
+ * @param out Tampon de sortie (NTP_MAX_PACKET octets).
+ * @return La taille du datagramme, 0 s'il n'y a plus de cookie (refaire exchange()).
+ */
+    size_t prepare(const NTP& ntp, uint8_t out[NTP_MAX_PACKET]);
+
+/**
+ * Vérifie une réponse : Unique Identifier de la dernière requête et authentificateur ; range les nouveaux cookies.
+ * @param packet Datagramme reçu.
+ * @param len Sa taille.
+ * @return Vrai si la réponse est authentique.
+ */
+    bool verify(const uint8_t packet[], const size_t len);
+
+    bool isReady() const { return ready && jar.size(); }
+    const char* getServer() const { return server; }
+    uint16_t getPort() const { return port; }
+    byte getCookies() const { return jar.size(); }
+
+  private:
+    bool record(const uint16_t type, const bool critical, const uint8_t body[], const size_t len, NtsKeChannel& channel);
+
+    AesSiv    c2s;
+    AesSiv    s2c;
+    CookieJar jar;
+    uint8_t   uid[32];
+    char      server[64];
+    uint16_t  port;
+    bool      ready;
+};
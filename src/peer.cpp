@@ -0,0 +1,61 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "peer.h"
+
+Peer::Peer() :
+  address(),
+  last(NTP::makeNTP(NTPMODE_SYMMETRIC_PASSIVE)),
+  xmt(0),
+  reach(0),
+  offset(0),
+  delay(0),
+  received(false)
+{}
+
+void Peer::configure(const Endpoint& aAddress) {
+  address = aAddress;
+}
+
+void Peer::prepare(NTP& packet) const {
+  if (!received) return;
+  packet.setOrigin(last);
+  packet.setT1(last.getT3());
+}
+
+void Peer::sent(const NTP& packet) {
+  xmt = packet.getT2();
+  reach <<= 1;
+}
+
+bool Peer::receive(const NTP& packet) {
+  const auto mode = packet.getMode();
+  if ((mode != NTPMODE_SYMMETRIC_ACTIVE) && (mode != NTPMODE_SYMMETRIC_PASSIVE)) return false;
+  if (!packet.getT2() || (packet.getT2() == last.getT2())) return false;  // duplicate.
+
+  last = packet;
+  received = true;
+
+// Bogus : le pair ne répond pas à notre dernier envoi (premier paquet ou paquet perdu).
+  if (!xmt || (packet.getT0() != xmt) || !packet.getT1()) return false;
+  xmt = 0;  // une seule mesure par envoi.
+
+  if ((packet.getT3() < packet.getT0()) || (packet.getT2() < packet.getT1())) return false;
+  reach |= 1;
+  offset = packet.getOffset();
+  delay = packet.getRTT();
+  return true;
+}
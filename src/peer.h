@@ -0,0 +1,94 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "transport.h"
+
+/**
+ * Association symétrique (modes 1 et 2) avec une autre horloge du site.
+ *
+ * Chaque paquet envoyé porte dans Origin le Transmit du dernier paquet reçu du pair et dans Receive l'heure
+ * locale de sa réception ; le paquet reçu en retour donne donc un échange complet T0..T3, comme en client/serveur.
+ * @see https://www.rfc-editor.org/rfc/rfc5905#section-8
+ */
+class Peer {
+  public:
+/**
+ * Public constructor ; association vide.
+ */
+    Peer();
+
+/**
+ * Configure l'association.
+ * @param address Adresse du pair.
+ */
+    void configure(const Endpoint& address);
+
+/**
+ * Complète un paquet symétrique avant l'envoi (Origin et Receive).
+ * @param packet Paquet préparé par Responder::symmetric().
+ */
+    void prepare(NTP& packet) const;
+
+/**
+ * Mémorise l'heure d'émission du paquet qui vient de partir.
+ * @param packet Paquet envoyé (champ Transmit estampillé).
+ */
+    void sent(const NTP& packet);
+
+/**
+ * Traite un paquet du pair.
+ * @param packet Paquet reçu (T3 = heure de réception).
+ * @return Vrai si le paquet répond à notre dernier envoi et donne une mesure valide.
+ */
+    bool receive(const NTP& packet);
+
+    bool isConfigured() const { return address.ip != 0; }
+    const Endpoint& getAddress() const { return address; }
+
+/**
+ * Indique si le pair a répondu à l'un des 8 derniers envois.
+ * @return Vrai si le registre d'accessibilité n'est pas nul.
+ */
+    bool isReachable() const { return reach != 0; }
+
+    uint8_t getStratum() const { return last.getStratum(); }
+    const char* getRefId() const { return last.getId(); }
+    int64_t getOffset() const { return offset; }
+    unsigned long getDelay() const { return delay; }
+
+/**
+ * Retourne la distance de synchronisation du pair : (délai racine + délai) / 2 + dispersion racine.
+ * @return Un temps en microsecondes.
+ */
+    uint32_t getDistance() const { return (uint64_t(last.getRootDelay()) + delay) / 2 + last.getRootDispersion(); }
+
+/**
+ * Retourne le dernier paquet valide reçu du pair.
+ * @return Le paquet.
+ */
+    const NTP& getPacket() const { return last; }
+
+  private:
+    Endpoint address;
+    NTP      last;        // dernier paquet reçu du pair (T3 = réception).
+    uint64_t xmt;         // Transmit de notre dernier envoi [µs].
+    uint8_t  reach;       // registre d'accessibilité (8 derniers envois).
+    int64_t  offset;      // [µs]
+    unsigned long delay;  // [µs]
+    bool     received;
+};
@@ -0,0 +1,72 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "ratelimit.h"
+
+#define ONE 256   // un jeton.
+
+RateLimiter::RateLimiter(const uint8_t aBurst, const uint32_t aInterval, const uint32_t aKodInterval) :
+  table(),
+  burst(aBurst * ONE),
+  interval(aInterval ? aInterval : 1),
+  kodInterval(aKodInterval)
+{}
+
+RateLimiter::Entry* RateLimiter::lookup(const uint32_t ip, const uint32_t now) {
+  const uint32_t hash = ip * 2654435761U;  // Knuth, multiplicatif.
+  const unsigned start = hash >> 16;
+  Entry* victim = nullptr;
+
+  for (unsigned i = 0; i < RATE_PROBE; ++i) {
+    Entry& e = table[(start + i) & (RATE_SLOTS - 1)];
+    if (e.used && (e.ip == ip)) return &e;
+    if (!e.used) {
+      if (!victim || victim->used) victim = &e;
+    } else if (!victim || (victim->used && (now - e.last > now - victim->last))) {
+      victim = &e;
+    }
+  }
+
+  victim->ip = ip;
+  victim->last = now;
+  victim->kod = now - kodInterval;
+  victim->tokens = burst;
+  victim->used = true;
+  return victim;
+}
+
+RateVerdict RateLimiter::check(const uint32_t ip, const uint32_t now) {
+  Entry& e = *lookup(ip, now);
+
+  const uint32_t refill = uint64_t(now - e.last) * ONE / interval;
+  if (refill >= uint32_t(burst - e.tokens)) {
+    e.tokens = burst;
+    e.last = now;
+  } else {
+    e.tokens += refill;
+    e.last += uint64_t(refill) * interval / ONE;  // garde le reliquat de temps non converti.
+  }
+
+  if (e.tokens >= ONE) {
+    e.tokens -= ONE;
+    return RATE_PASS;
+  }
+  if (now - e.kod >= kodInterval) {
+    e.kod = now;
+    return RATE_KOD;
+  }
+  return RATE_DROP;
+}
@@ -0,0 +1,72 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Taille de la table des clients (puissance de 2) et longueur maximale de sondage.
+ */
+#define RATE_SLOTS 256
+#define RATE_PROBE 8
+
+/**
+ * Décision du limiteur pour une requête.
+ */
+enum RateVerdict { RATE_PASS, RATE_KOD, RATE_DROP };
+
+/**
+ * Limiteur de débit par adresse source (seau à jetons) pour le mode serveur.
+ *
+ * La table est de taille fixe, en adressage ouvert : une adresse est cherchée dans au plus RATE_PROBE cases
+ * à partir de son hash, et si elle n'y est pas, elle prend une case vide ou celle du client le moins
+ * récemment vu dans cette fenêtre. Aucune allocation, coût constant par requête.
+ */
+class RateLimiter {
+  public:
+/**
+ * Public constructor.
+ * @param burst Nombre de requêtes acceptées d'affilée.
+ * @param interval Intervalle moyen minimal entre deux requêtes [ms].
+ * @param kodInterval Intervalle minimal entre deux KoD envoyés au même client [ms].
+ */
+    RateLimiter(const uint8_t burst = 8, const uint32_t interval = 2000, const uint32_t kodInterval = 8000);
+
+/**
+ * Décompte une requête d'un client.
+ * @param ip Adresse IPv4 du client (ordre réseau).
+ * @param now Horloge monotone [ms].
+ * @return RATE_PASS pour répondre, RATE_KOD pour répondre par un KoD RATE, RATE_DROP pour ignorer.
+ */
+    RateVerdict check(const uint32_t ip, const uint32_t now);
+
+  private:
+    struct Entry {
+      uint32_t ip;
+      uint32_t last;     // [ms]
+      uint32_t kod;      // [ms] dernier KoD envoyé.
+      uint16_t tokens;   // jetons x 256.
+      bool     used;
+    };
+
+    Entry* lookup(const uint32_t ip, const uint32_t now);
+
+    Entry    table[RATE_SLOTS];
+    uint16_t burst;      // jetons x 256.
+    uint32_t interval;
+    uint32_t kodInterval;
+};
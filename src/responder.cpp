@@ -0,0 +1,79 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "responder.h"
+
+#define MAXPOLL_KOD 10  // poll annoncé dans un KoD : 1024 s.
+
+Responder::Responder() :
+  tmpl(NTP::makeNTP(NTPMODE_SERVER)),
+  synchronized(false),
+  leap(0),
+  refTime(0),
+  rootDelay(0),
+  rootDisp(0)
+{}
+
+void Responder::update(const NTP& upstream, const char refId[4], const uint8_t pollExp, const uint64_t& aRefTime) {
+  const uint8_t stratum = upstream.getStratum() + 1;
+  if (!upstream.getStratum() || stratum >= MAXSTRAT) return;
+
+  tmpl.setHeader(0, 4, NTPMODE_SERVER);
+  tmpl.setClock(stratum, pollExp, LOCAL_PRECISION, refId);
+  tmpl.setRefTime(aRefTime);
+  refTime = aRefTime;
+  synchronized = true;
+}
+
+void Responder::setRoot(const uint32_t delay, const uint32_t dispersion) {
+  rootDelay = delay;
+  rootDisp = dispersion;
+  tmpl.setRoot(delay, dispersion);
+}
+
+bool Responder::respond(const NTP& request, NTP& reply) const {
+  if (!synchronized || request.getMode() != NTPMODE_CLIENT) return false;
+  const auto version = request.getVersion();
+  if (version < 1 || version > 4) return false;
+
+  reply = tmpl;
+  reply.setHeader(leap, version, NTPMODE_SERVER);
+  reply.setOrigin(request);
+  reply.setT1(request.getT3());
+  const uint64_t age = request.getT3() > refTime ? request.getT3() - refTime : 0;
+  reply.setRoot(rootDelay, rootDisp + age * PHI / 1000000);
+  return true;
+}
+
+bool Responder::broadcast(NTP& packet) const {
+  if (!synchronized) return false;
+  packet = tmpl;
+  packet.setHeader(leap, 4, NTPMODE_BROADCAST);
+  return true;
+}
+
+void Responder::symmetric(NTP& packet, const NtpMode mode) const {
+  packet = tmpl;
+  packet.setHeader(leap, 4, mode);
+}
+
+void Responder::kiss(const NTP& request, NTP& reply, const char code[4]) const {
+  reply = NTP::makeNTP(NTPMODE_SERVER);
+  reply.setHeader(3, request.getVersion(), NTPMODE_SERVER);
+  reply.setClock(0, MAXPOLL_KOD, LOCAL_PRECISION, code);
+  reply.setOrigin(request);
+  reply.setT1(request.getT3());
+}
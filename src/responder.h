@@ -0,0 +1,112 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "ntp.h"
+
+/**
+ * Précision annoncée de l'horloge locale (2^-20 s ~ 1 µs, résolution de getMicros).
+ */
+#define LOCAL_PRECISION -20
+
+/**
+ * Répondeur NTP en mode serveur (strate N+1).
+ *
+ * La réponse est un modèle pré-rempli (entête, strate, poll, précision, refId, heure de référence) mis à jour
+ * à chaque synchronisation ; répondre à une requête ne fait que recopier ce modèle et y poser les champs
+ * Origin et Receive. Le champ Transmit est posé par le transport au moment de l'émission.
+ */
+class Responder {
+  public:
+/**
+ * Public constructor ; le répondeur reste muet tant qu'il n'est pas synchronisé.
+ */
+    Responder();
+
+/**
+ * Met à jour le modèle de réponse après une synchronisation réussie.
+ * @param upstream Réponse du serveur amont.
+ * @param refId Identifiant du serveur amont (son adresse IPv4).
+ * @param pollExp Exposant de polling local.
+ * @param refTime Heure locale de la synchronisation en microsecondes depuis le 1er janvier 1900.
+ */
+    void update(const NTP& upstream, const char refId[4], const uint8_t pollExp, const uint64_t& refTime);
+
+/**
+ * Prépare la réponse à une requête client.
+ * @param request Requête reçue (T3 = heure de réception).
+ * @param reply Paquet recevant la réponse.
+ * @return Faux si la requête doit être ignorée (non synchronisé, mode incorrect).
+ */
+    bool respond(const NTP& request, NTP& reply) const;
+
+/**
+ * Prépare un paquet diffusé (mode 5) ; le champ Transmit est posé par le transport.
+ * @param packet Paquet recevant la diffusion.
+ * @return Faux tant que le répondeur n'est pas synchronisé.
+ */
+    bool broadcast(NTP& packet) const;
+
+/**
+ * Prépare un paquet symétrique (modes 1 et 2) ; strate 16 tant que le répondeur n'est pas synchronisé.
+ * @param packet Paquet recevant les champs de l'horloge locale.
+ * @param mode NTPMODE_SYMMETRIC_ACTIVE ou NTPMODE_SYMMETRIC_PASSIVE.
+ */
+    void symmetric(NTP& packet, const NtpMode mode) const;
+
+/**
+ * Prépare un paquet Kiss-o'-Death (strate 0, LI 3) en réponse à une requête.
+ * @param request Requête reçue.
+ * @param reply Paquet recevant la réponse.
+ * @param code Code KoD sur 4 caractères ("RATE", "DENY", "RSTR").
+ */
+    void kiss(const NTP& request, NTP& reply, const char code[4]) const;
+
+/**
+ * Indique si le répondeur est synchronisé et peut répondre.
+ * @return Vrai après la première mise à jour.
+ */
+    bool isSynchronized() const { return synchronized; }
+
+/**
+ * Retourne la strate annoncée par le répondeur.
+ * @return Strate du serveur amont + 1.
+ */
+    uint8_t getStratum() const { return tmpl.getStratum(); }
+
+/**
+ * Positionne l'annonce de seconde intercalaire des paquets émis.
+ * @param li 0, 1 (insertion) ou 2 (suppression) en fin de mois.
+ */
+    void setLeap(const uint8_t li) { leap = li; }
+
+/**
+ * Positionne la distance à la référence primaire annoncée ; la dispersion croît ensuite de PHI depuis
+ * l'heure de référence, à chaque réponse.
+ * @param delay Délai racine en microsecondes.
+ * @param dispersion Dispersion racine à l'heure de référence, en microsecondes.
+ */
+    void setRoot(const uint32_t delay, const uint32_t dispersion);
+
+  private:
+    NTP      tmpl;
+    bool     synchronized;
+    uint8_t  leap;
+    uint64_t refTime;       // [µs depuis 1900]
+    uint32_t rootDelay;     // [µs]
+    uint32_t rootDisp;      // [µs] à refTime.
+};
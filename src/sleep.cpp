@@ -0,0 +1,81 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "sleep.h"
+
+#include <cmath>
+
+#define SLEEP_AVG  4      // Constante de temps des moyennes (en nombre de mesures).
+#define SLEEP_GAIN 0.5    // Part de l'écart de fréquence mesuré reprise à chaque réveil.
+
+SleepClock::SleepClock(SleepState& aState) :
+  state(aState),
+  calTicks(0),
+  calMicros(0),
+  calibrating(false)
+{}
+
+void SleepClock::reset(const double period, const unsigned long epoch, const uint32_t error, const unsigned poll) {
+  state = SleepState();
+  state.magic = SLEEP_MAGIC;
+  state.period = period;
+  state.syncEpoch = epoch;
+  state.syncError = error;
+  state.nextPoll = epoch + poll;
+}
+
+void SleepClock::calibrate(const uint64_t ticks, const int64_t micros) {
+  if (!calibrating) {
+    calTicks = ticks;
+    calMicros = micros;
+    calibrating = true;
+    return;
+  }
+  if (!isValid() || (ticks - calTicks < SLEEP_CALIBRATION)) return;
+  const double period = double(micros - calMicros) / double(ticks - calTicks);
+  state.period += (period - state.period) / SLEEP_AVG;
+  calTicks = ticks;
+  calMicros = micros;
+}
+
+void SleepClock::sleep(const uint64_t now, const uint64_t ticks) {
+  state.time = now;
+  state.ticks = ticks;
+}
+
+uint64_t SleepClock::wake(const uint64_t ticks) {
+  const double elapsed = double(ticks - state.ticks) * state.period;
+  const uint64_t slept = uint64_t(elapsed * (1 + state.ppm * 1e-6) + 0.5);
+  state.slept += slept;     // Cumul de tous les sommeils depuis le dernier polling.
+  return state.time + slept;
+}
+
+void SleepClock::learn(const int64_t offset, const unsigned long epoch, const uint32_t error) {
+  if (state.slept >= SLEEP_LEARN * 1000000ULL) {
+    const double residual = double(offset) / state.slept * 1e6;  // [ppm]
+    state.ppm += SLEEP_GAIN * residual;
+    state.spread += (fabs(residual) - state.spread) / SLEEP_AVG;
+  }
+  state.slept = 0;
+  state.syncEpoch = epoch;
+  state.syncError = error;
+}
+
+uint32_t SleepClock::getMaxError(const unsigned long epoch) const {
+  const uint64_t e = state.syncError + uint64_t(epoch - state.syncEpoch) * (state.spread + SLEEP_PHI);
+  return e > UINT32_MAX ? UINT32_MAX : uint32_t(e);
+}
@@ -0,0 +1,135 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <cstdint>
+
+#define SLEEP_MAGIC       0x534C5031  // "SLP1"
+#define SLEEP_CALIBRATION 65536       // Ticks RTC minimum pour mesurer la période (~0,4 s à 150 kHz).
+#define SLEEP_LEARN       16          // Durée de sommeil minimale pour apprendre l'erreur du compteur RTC [s].
+#define SLEEP_PHI         50          // Tolérance ajoutée à l'erreur apprise du compteur RTC [ppm].
+
+/**
+ * Etat conservé en mémoire RTC (RTC_DATA_ATTR) pendant le sommeil profond. Structure simple, sans constructeur :
+ * elle n'est initialisée qu'au démarrage à froid.
+ */
+struct SleepState {
+  uint32_t      magic;
+  uint64_t      time;       // Heure locale à l'endormissement [µs depuis 1900].
+  uint64_t      ticks;      // Compteur RTC à l'endormissement.
+  uint64_t      slept;      // Durée estimée des sommeils depuis le dernier polling [µs].
+  double        period;     // Période du compteur RTC mesurée contre l'horloge principale [µs].
+  double        ppm;        // Correction apprise au réveil (écart NTP / durée de sommeil).
+  double        spread;     // Moyenne des écarts résiduels [ppm].
+  unsigned long syncEpoch;  // Dernière synchronisation [s depuis 1970].
+  uint32_t      syncError;  // Erreur maximale à cette synchronisation [µs].
+  unsigned long nextPoll;   // Prochain réveil avec polling [s depuis 1970].
+};
+
+/**
+ * Horloge de sommeil profond : pendant le sommeil, seul le compteur RTC lent (oscillateur RC ~150 kHz ou quartz
+ * 32 kHz) tourne. Sa période est mesurée contre le timer principal pendant les réveils, puis l'écart NTP
+ * constaté à chaque réveil avec polling corrige le reste (dérive en température du RC).
+ *
+ * Les lectures du compteur et du timer sont fournies par l'appelant, si bien que la version hôte peut simuler
+ * les deux oscillateurs.
+ */
+class SleepClock {
+  public:
+/**
+ * Public constructor.
+ * @param aState Etat en mémoire RTC.
+ */
+    SleepClock(SleepState& aState);
+
+/**
+ * Indique que l'état en mémoire RTC est valide (réveil de sommeil profond).
+ */
+    bool isValid() const { return state.magic == SLEEP_MAGIC; }
+
+/**
+ * Initialise l'état après une synchronisation à froid.
+ * @param period Période nominale du compteur RTC [µs].
+ * @param epoch Heure UTC de la synchronisation [s].
+ * @param error Erreur maximale de l'horloge locale [µs].
+ * @param poll Intervalle entre deux réveils avec polling [s].
+ */
+    void reset(const double period, const unsigned long epoch, const uint32_t error, const unsigned poll);
+
+/**
+ * Mesure la période du compteur RTC contre le timer principal pendant un réveil. Le premier appel après
+ * le démarrage fixe la référence, les suivants affinent la période s'ils en sont assez éloignés.
+ * @param ticks Compteur RTC.
+ * @param micros Timer principal [µs].
+ */
+    void calibrate(const uint64_t ticks, const int64_t micros);
+
+/**
+ * Mémorise l'heure à l'endormissement.
+ * @param now Heure locale [µs depuis 1900].
+ * @param ticks Compteur RTC au même instant.
+ */
+    void sleep(const uint64_t now, const uint64_t ticks);
+
+/**
+ * Estime l'heure au réveil et ajoute la durée du sommeil au cumul depuis le dernier polling.
+ * @param ticks Compteur RTC.
+ * @return L'heure locale [µs depuis 1900].
+ */
+    uint64_t wake(const uint64_t ticks);
+
+/**
+ * Apprend l'erreur du compteur RTC à partir de l'écart mesuré au polling, rapporté au cumul des sommeils
+ * depuis le précédent, puis remet ce cumul à zéro.
+ * @param offset Ecart mesuré [µs], positif si l'horloge locale retarde.
+ * @param epoch Heure UTC de la mesure [s].
+ * @param error Erreur maximale de la mesure (distance à la référence) [µs].
+ */
+    void learn(const int64_t offset, const unsigned long epoch, const uint32_t error);
+
+/**
+ * Retourne la borne d'erreur de l'heure estimée : erreur à la synchronisation, augmentée de l'écart résiduel
+ * appris et de SLEEP_PHI par seconde écoulée.
+ * @param epoch Heure UTC courante [s].
+ * @return Une durée en µs.
+ */
+    uint32_t getMaxError(const unsigned long epoch) const;
+
+/**
+ * Heure UTC du prochain réveil avec polling [s].
+ */
+    unsigned long getNextPoll() const { return state.nextPoll; }
+    void setNextPoll(const unsigned long epoch) { state.nextPoll = epoch; }
+
+/**
+ * Heure UTC de la dernière synchronisation [s].
+ */
+    unsigned long getLastSync() const { return state.syncEpoch; }
+
+/**
+ * Période mesurée [µs] et correction apprise [ppm] du compteur RTC.
+ */
+    double getPeriod() const { return state.period; }
+    double getPpm() const { return state.ppm; }
+
+  private:
+    SleepState& state;
+    uint64_t    calTicks;    // Référence de la mesure de période (mémoire ordinaire : perdue en sommeil).
+    int64_t     calMicros;
+    bool        calibrating;
+};
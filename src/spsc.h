@@ -0,0 +1,67 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * File sans verrou à un producteur et un consommateur (tâches sur deux coeurs différents).
+ *
+ * Tampon circulaire de N cases (puissance de 2) ; les index ne font que croître et seul le producteur écrit
+ * head, seul le consommateur écrit tail. L'ordre release/acquire publie le contenu d'une case avant son index.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N && !(N & (N - 1)), "N doit être une puissance de 2");
+
+  public:
+/**
+ * Public constructor.
+ */
+    SpscQueue() : head(0), tail(0) {}
+
+/**
+ * Ajoute un élément (producteur seulement).
+ * @return Faux si la file est pleine ; l'élément est alors perdu.
+ */
+    bool push(const T& item) {
+      const size_t h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) == N) return false;
+      items[h & (N - 1)] = item;
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+/**
+ * Retire le plus ancien élément (consommateur seulement).
+ * @return Faux si la file est vide.
+ */
+    bool pop(T& item) {
+      const size_t t = tail.load(std::memory_order_relaxed);
+      if (head.load(std::memory_order_acquire) == t) return false;
+      item = items[t & (N - 1)];
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+  private:
+    T items[N];
+    std::atomic<size_t> head;   // Prochaine case écrite.
+    std::atomic<size_t> tail;   // Prochaine case lue.
+};
@@ -0,0 +1,114 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "thermal.h"
+
+#include <cmath>
+
+#if !defined(__linux__)
+#include <Arduino.h>
+#endif
+
+#define THERMAL_AVG     8     // Constante de temps de la moyenne d'une tranche (en nombre de mesures).
+#define THERMAL_SAMPLES 3     // Mesures nécessaires avant de prédire.
+
+#if !defined(__linux__)
+bool InternalTemperature::read(float& celsius) {
+  const float t = temperatureRead();
+  if (std::isnan(t) || (t < -40) || (t > 125)) return false;
+  celsius = t;
+  return true;
+}
+#endif
+
+ThermalModel::ThermalModel() :
+  buckets(),
+  used(0),
+  a(0), b(0), c(0),
+  low(0), high(0)
+{}
+
+void ThermalModel::learn(const float celsius, const double ppm) {
+  int i = int(floor((celsius - THERMAL_MIN) / THERMAL_STEP));
+  if (i < 0) i = 0;
+  if (i >= THERMAL_BUCKETS) i = THERMAL_BUCKETS - 1;
+
+  Bucket& bucket = buckets[i];
+  if (!bucket.count) {
+    bucket.celsius = celsius;
+    bucket.ppm = ppm;
+    ++used;
+  } else {
+    const unsigned n = bucket.count < THERMAL_AVG ? bucket.count + 1 : THERMAL_AVG;
+    bucket.celsius += (celsius - bucket.celsius) / n;
+    bucket.ppm += (ppm - bucket.ppm) / n;
+  }
+  if (bucket.count < UINT16_MAX) ++bucket.count;
+
+  fit();
+}
+
+void ThermalModel::fit() {
+// Sommes pondérées des moments : s[k] = Σ w.x^k, t[k] = Σ w.x^k.y.
+  double s[5] = {}, t[3] = {};
+  bool first = true;
+  for (const Bucket& bucket : buckets) {
+    if (!bucket.count) continue;
+    const double w = bucket.count < THERMAL_AVG ? bucket.count : THERMAL_AVG;
+    const double x = bucket.celsius - THERMAL_CENTER;
+    double xk = 1;
+    for (int k = 0; k < 5; ++k) {
+      s[k] += w * xk;
+      if (k < 3) t[k] += w * xk * bucket.ppm;
+      xk *= x;
+    }
+    if (first || (bucket.celsius < low)) low = bucket.celsius;
+    if (first || (bucket.celsius > high)) high = bucket.celsius;
+    first = false;
+  }
+  a = b = c = 0;
+  if (!used) return;
+
+  if (used >= 3) {  // Cramer sur les équations normales 3x3.
+    const double det = s[0] * (s[2] * s[4] - s[3] * s[3]) - s[1] * (s[1] * s[4] - s[3] * s[2]) + s[2] * (s[1] * s[3] - s[2] * s[2]);
+    if (fabs(det) > 1e-9) {
+      a = (t[0] * (s[2] * s[4] - s[3] * s[3]) - s[1] * (t[1] * s[4] - s[3] * t[2]) + s[2] * (t[1] * s[3] - s[2] * t[2])) / det;
+      b = (s[0] * (t[1] * s[4] - s[3] * t[2]) - t[0] * (s[1] * s[4] - s[3] * s[2]) + s[2] * (s[1] * t[2] - t[1] * s[2])) / det;
+      c = (s[0] * (s[2] * t[2] - t[1] * s[3]) - s[1] * (s[1] * t[2] - t[1] * s[2]) + t[0] * (s[1] * s[3] - s[2] * s[2])) / det;
+      return;
+    }
+  }
+  if (used >= 2) {  // droite.
+    const double det = s[0] * s[2] - s[1] * s[1];
+    if (fabs(det) > 1e-9) {
+      a = (t[0] * s[2] - s[1] * t[1]) / det;
+      b = (s[0] * t[1] - s[1] * t[0]) / det;
+      return;
+    }
+  }
+  a = t[0] / s[0];  // constante.
+}
+
+bool ThermalModel::predict(const float celsius, double& ppm) const {
+  unsigned samples = 0;
+  for (const Bucket& bucket : buckets) samples += bucket.count;
+  if (samples < THERMAL_SAMPLES) return false;
+
+  const double x = (celsius < low ? low : (celsius > high ? high : celsius)) - THERMAL_CENTER;
+  ppm = a + b * x + c * x * x;
+  return true;
+}
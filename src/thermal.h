@@ -0,0 +1,110 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <cstdint>
+
+#define THERMAL_BUCKETS 32      // Nombre de tranches de température.
+#define THERMAL_MIN     -10.0   // Borne basse de la première tranche [°C].
+#define THERMAL_STEP    2.5     // Largeur d'une tranche [°C].
+#define THERMAL_CENTER  25.0    // Température de référence de l'ajustement [°C].
+
+/**
+ * Source de température de l'oscillateur ; la version hôte peut la simuler.
+ */
+class TemperatureSource {
+  public:
+/**
+ * Lit la température courante.
+ * @param celsius Reçoit la température [°C].
+ * @return Faux si la lecture a échoué ou est hors limites.
+ */
+    virtual bool read(float& celsius) = 0;
+
+    virtual ~TemperatureSource() {}
+};
+
+/**
+ * Capteur interne de l'ESP32 (proche du quartz, précision de quelques degrés mais bonne répétabilité).
+ * Non disponible dans la version hôte.
+ */
+class InternalTemperature : public TemperatureSource {
+  public:
+    bool read(float& celsius) override;
+};
+
+/**
+ * Modèle fréquence / température de l'oscillateur, appris en continu.
+ *
+ * Chaque mesure de fréquence est rangée dans la tranche de sa température (moyenne glissante par tranche),
+ * puis une parabole f(T) = a + b.(T - 25) + c.(T - 25)² est ajustée aux tranches par moindres carrés pondérés
+ * (allure d'un quartz autour de son point d'inversion). Avec moins de trois tranches, l'ajustement se réduit
+ * à une droite ou une constante. La prédiction est bornée à la plage de températures observée.
+ */
+class ThermalModel {
+  public:
+/**
+ * Public constructor.
+ */
+    ThermalModel();
+
+/**
+ * Ajoute une mesure de fréquence et met à jour l'ajustement.
+ * @param celsius Température pendant l'intervalle de mesure [°C].
+ * @param ppm Fréquence mesurée sur cet intervalle [ppm].
+ */
+    void learn(const float celsius, const double ppm);
+
+/**
+ * Prédit la fréquence de l'oscillateur à une température.
+ * @param celsius Température courante [°C].
+ * @param ppm Reçoit la fréquence prédite [ppm].
+ * @return Faux tant que le modèle n'a pas assez de mesures.
+ */
+    bool predict(const float celsius, double& ppm) const;
+
+/**
+ * Retourne le nombre de tranches renseignées.
+ */
+    uint8_t getBuckets() const { return used; }
+
+/**
+ * Retourne les coefficients de l'ajustement f(T) = a + b.(T - 25) + c.(T - 25)².
+ * @param offset Reçoit a [ppm].
+ * @param slope Reçoit b [ppm/°C].
+ * @param curvature Reçoit c [ppm/°C²].
+ */
+    void getFit(double& offset, double& slope, double& curvature) const { offset = a; slope = b; curvature = c; }
+
+  private:
+/**
+ * Recalcule les coefficients à partir des tranches.
+ */
+    void fit();
+
+    struct Bucket {
+      float    celsius;   // Température moyenne des mesures [°C].
+      double   ppm;       // Fréquence moyenne [ppm].
+      uint16_t count;
+    };
+
+    Bucket  buckets[THERMAL_BUCKETS];
+    uint8_t used;       // Tranches renseignées.
+    double  a, b, c;    // Coefficients de l'ajustement.
+    float   low, high;  // Plage observée [°C].
+};
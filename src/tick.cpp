@@ -0,0 +1,46 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "tick.h"
+
+TickScheduler::TickScheduler(ESP32Time& aTime, void (*aCallback)(void*), void* aArg) :
+  time(aTime),
+  callback(aCallback),
+  arg(aArg),
+  timer(nullptr)
+{}
+
+bool TickScheduler::begin() {
+  esp_timer_create_args_t args = {};
+  args.callback = fire;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "tick";
+  if (esp_timer_create(&args, &timer) != ESP_OK) return false;
+  arm();
+  return true;
+}
+
+void TickScheduler::fire(void* self) {
+  TickScheduler& tick = *(TickScheduler*)self;
+  if (tick.time.getMicros() < TICK_EARLY) tick.callback(tick.arg);
+  tick.arm();
+}
+
+void TickScheduler::arm() {
+  esp_timer_start_once(timer, 1000000 - time.getMicros());
+}
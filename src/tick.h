@@ -0,0 +1,64 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <ESP32Time.h>
+#include <esp_timer.h>
+
+#define TICK_EARLY 500000   // Un déclenchement à plus de TICK_EARLY µs de la seconde suivante est en avance [µs].
+
+/**
+ * Tic de seconde cadencé par un esp_timer : le timer est réarmé à chaque seconde sur l'horloge disciplinée,
+ * si bien que le rappel s'exécute à quelques dizaines de µs du début de la seconde au lieu d'être détecté
+ * par loop() avec un retard aléatoire. Un déclenchement en avance (horloge ralentie par une correction) est
+ * simplement réarmé pour le reste de la seconde.
+ *
+ * Le rappel s'exécute dans la tâche esp_timer : il doit être bref (notifier une tâche, par exemple).
+ */
+class TickScheduler {
+  public:
+/**
+ * Public constructor.
+ * @param aTime Horloge disciplinée.
+ * @param aCallback Rappel à chaque nouvelle seconde.
+ * @param aArg Argument du rappel.
+ */
+    TickScheduler(ESP32Time& aTime, void (*aCallback)(void*), void* aArg);
+
+/**
+ * Crée le timer et l'arme pour la prochaine seconde.
+ * @return Faux si le timer n'a pas pu être créé.
+ */
+    bool begin();
+
+  private:
+/**
+ * Rappel du timer : appelle le rappel de l'application puis réarme.
+ */
+    static void fire(void* self);
+
+/**
+ * Arme le timer pour la prochaine seconde de l'horloge disciplinée.
+ */
+    void arm();
+
+    ESP32Time&          time;
+    void              (*callback)(void*);
+    void*               arg;
+    esp_timer_handle_t  timer;
+};
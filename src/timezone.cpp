@@ -42,6 +42,42 @@ time_t Timezone::localtime(const time_t& utc) const {
   return utc + (stdEpoch < dstEpoch ? dst.offset : std.offset) * 60;
 }
 
+time_t Timezone::utc(const time_t& local, const bool later) const {
+  const time_t a = local - std.offset * 60;
+  const time_t b = local - dst.offset * 60;
+  const time_t first = a < b ? a : b;
+  const time_t second = a < b ? b : a;
+  const bool firstOk = localtime(first) == local;
+  const bool secondOk = localtime(second) == local;
+
+  if (firstOk && secondOk) return later ? second : first;   // recouvrement : l'heure locale a lieu deux fois.
+  if (firstOk) return first;
+  if (secondOk) return second;
+
+  struct tm tmLocal;    // trou : l'heure locale n'existe pas, l'alarme a lieu au changement d'heure.
+  gmtime_r(&local, &tmLocal);
+  const TimeChangeRule* const rules[] = { &std, &dst };
+  for (const auto rule : rules) {
+    const time_t change = getChange(*rule, tmLocal.tm_year);
+    if ((change >= first) && (change <= second)) return change;
+  }
+  return first;
+}
+
+time_t Timezone::nextChange(const time_t& utc) const {
+  struct tm tmUTC;
+  gmtime_r(&utc, &tmUTC);
+  time_t next = 0;
+  for (int year = tmUTC.tm_year; year <= tmUTC.tm_year + 1; ++year) {
+    const time_t changes[] = { getChange(std, year), getChange(dst, year) };
+    for (const auto change : changes) {
+      if ((change >= utc) && (!next || (change < next))) next = change;
+    }
+    if (next) return next;
+  }
+  return next;
+}
+
 time_t Timezone::getChange(const TimeChangeRule rule, const int year) {
   struct tm tm = { 0, 0, rule.hour, 1, 0, year, 0, 0, 0 }; // 1st jan 1900.
 //  Serial.println(rule.abbrev);
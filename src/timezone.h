@@ -37,6 +37,21 @@ class Timezone {
     Timezone(const TimeChangeRule& aStd, const TimeChangeRule& aDst);
     time_t localtime(const time_t& utc) const;
 
+/**
+ * Convertit une heure locale en UTC.
+ * @param local Heure locale (temps unix décalé).
+ * @param later Dans le recouvrement d'automne, choisit la seconde occurrence au lieu de la première.
+ * @return L'heure UTC ; pour une heure locale sautée au printemps, l'instant du changement d'heure.
+ */
+    time_t utc(const time_t& local, const bool later = false) const;
+
+/**
+ * Retourne le prochain changement d'heure.
+ * @param utc Heure UTC.
+ * @return Le premier changement à partir de utc ; l'ancien décalage s'applique encore à cet instant.
+ */
+    time_t nextChange(const time_t& utc) const;
+
   protected:
 /**
  * Retourne l'heure du changement horaire.
@@ -0,0 +1,95 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "tls_channel.h"
+
+#include <cstring>
+
+#if !defined(__linux__)
+#include <esp_tls.h>
+#include <esp_crt_bundle.h>
+#include <esp_idf_version.h>
+#include <mbedtls/ssl.h>
+
+#if defined(MBEDTLS_SSL_PROTO_TLS1_3) && defined(MBEDTLS_SSL_KEYING_MATERIAL_EXPORT)
+#define TLS_EXPORTER 1
+#else
+#define TLS_EXPORTER 0
+#endif
+#endif
+
+#define TLS_TIMEOUT 5000   // [ms] poignée de main et chaque lecture.
+
+TlsChannel::TlsChannel() :
+  tls(nullptr)
+{}
+
+#if !defined(__linux__)
+TlsChannel::~TlsChannel() {
+  if (tls) esp_tls_conn_destroy(tls);
+}
+
+bool TlsChannel::connect(const char host[], const uint16_t port) {
+  if (!TLS_EXPORTER) return false;
+  static const char* alpn[] = { "ntske/1", nullptr };
+  esp_tls_cfg_t cfg = {};
+  cfg.alpn_protos = alpn;
+  cfg.crt_bundle_attach = esp_crt_bundle_attach;
+  cfg.timeout_ms = TLS_TIMEOUT;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 2, 0)
+  cfg.tls_version = ESP_TLS_VER_TLS_1_3;
+#endif
+
+  if (tls) esp_tls_conn_destroy(tls);
+  tls = esp_tls_init();
+  return tls && (esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls) == 1);
+}
+
+bool TlsChannel::write(const uint8_t data[], const size_t len) {
+  for (size_t done = 0; tls && (done < len); ) {
+    const ssize_t n = esp_tls_conn_write(tls, data + done, len - done);
+    if (n <= 0) return false;
+    done += n;
+  }
+  return tls != nullptr;
+}
+
+bool TlsChannel::read(uint8_t data[], const size_t len) {
+  for (size_t done = 0; tls && (done < len); ) {
+    const ssize_t n = esp_tls_conn_read(tls, data + done, len - done);
+    if (n <= 0) return false;
+    done += n;
+  }
+  return tls != nullptr;
+}
+
+bool TlsChannel::exportKey(const char label[], const uint8_t context[], const size_t contextLen, uint8_t out[], const size_t len) {
+#if TLS_EXPORTER
+  mbedtls_ssl_context* const ssl = tls ? (mbedtls_ssl_context*)esp_tls_get_ssl_context(tls) : nullptr;
+  return ssl && !mbedtls_ssl_export_keying_material(ssl, out, len, label, strlen(label), context, contextLen, 1);
+#else
+  return false;
+#endif
+}
+
+#else   // Portage Linux : les essais utilisent StandInChannel (linux_nts.h).
+TlsChannel::~TlsChannel() {}
+
+bool TlsChannel::connect(const char[], const uint16_t) { return false; }
+bool TlsChannel::write(const uint8_t[], const size_t) { return false; }
+bool TlsChannel::read(uint8_t[], const size_t) { return false; }
+bool TlsChannel::exportKey(const char[], const uint8_t[], const size_t, uint8_t[], const size_t) { return false; }
+#endif
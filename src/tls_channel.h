@@ -0,0 +1,49 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "nts.h"
+
+struct esp_tls;
+
+/**
+ * Canal NTS-KE de l'ESP32 : TLS 1.3 par esp_tls (certificat du serveur vérifié par le bundle ESP-IDF,
+ * ALPN "ntske/1") et exportateur de clés de mbedtls (RFC 8446 §7.5).
+ *
+ * L'exportateur demande mbedtls 3.6 avec MBEDTLS_SSL_PROTO_TLS1_3 et MBEDTLS_SSL_KEYING_MATERIAL_EXPORT :
+ * sans eux connect() échoue, le client NTS ne devient jamais prêt et aucun poll non authentifié n'est envoyé.
+ */
+class TlsChannel : public NtsKeChannel {
+  public:
+    TlsChannel();
+    ~TlsChannel();
+
+/**
+ * Ouvre la session TLS (poignée de main bloquante, au plus TLS_TIMEOUT ms).
+ * @param host Nom du serveur NTS-KE, vérifié dans son certificat.
+ * @param port Port TCP du serveur.
+ * @return Vrai si la session est établie.
+ */
+    bool connect(const char host[], const uint16_t port);
+
+    bool write(const uint8_t data[], const size_t len) override;
+    bool read(uint8_t data[], const size_t len) override;
+    bool exportKey(const char label[], const uint8_t context[], const size_t contextLen, uint8_t out[], const size_t len) override;
+
+  private:
+    struct esp_tls* tls;
+};
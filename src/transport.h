@@ -0,0 +1,170 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include "ntp.h"
+#include "leap.h"
+
+/**
+ * Signature des paquets émis, implémentée par le trousseau de clés (auth.h) : le transport n'en dépend pas
+ * et se construit sans mbedtls.
+ */
+class PacketSigner {
+  public:
+    virtual ~PacketSigner() {}
+
+/**
+ * Calcule et ajoute le MAC d'un paquet portant un Key ID.
+ * @param ntp Paquet entièrement renseigné.
+ * @return Faux si la clé est inconnue.
+ */
+    virtual bool sign(NTP& ntp) = 0;
+};
+
+/**
+ * Adresse IPv4 (ordre réseau) et port UDP d'un correspondant.
+ */
+struct Endpoint {
+  uint32_t ip;
+  uint16_t port;
+};
+
+/**
+ * Interface d'un transport UDP utilisé par le moteur de synchronisation.
+ * Chaque implémentation estampille le champ Transmit juste avant l'émission et T3 au plus près de la réception.
+ */
+class Transport {
+  public:
+    virtual ~Transport() {}
+
+/**
+ * Associe un trousseau de clés : les paquets portant un Key ID sont signés juste après l'estampille.
+ * @param aKeys Le trousseau (Keyring), ou nullptr.
+ */
+    void setKeyring(PacketSigner* aKeys) { keys = aKeys; }
+
+/**
+ * Associe la gestion des secondes intercalaires : now() et les estampilles de réception donnent alors l'heure
+ * publiée (lissée si besoin). Réservé au transport du serveur, celui de l'amont mesure l'horloge locale.
+ * @param aLeap La gestion des secondes intercalaires, ou nullptr.
+ */
+    void setLeap(const Leap* aLeap) { leap = aLeap; }
+
+/**
+ * Ouvre le port UDP local.
+ * @param port Port local.
+ * @return Vrai si le port est ouvert.
+ */
+    virtual bool begin(const uint16_t port) = 0;
+
+/**
+ * Ouvre le port UDP local et rejoint un groupe multicast.
+ * @param group Adresse du groupe (ex. "224.0.1.1").
+ * @param port Port local.
+ * @return Vrai si le port est ouvert et le groupe rejoint.
+ */
+    virtual bool beginMulticast(const char group[], const uint16_t port) = 0;
+
+/**
+ * Retourne l'heure courante de l'horloge locale.
+ * @return Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    virtual uint64_t now() const = 0;
+
+/**
+ * Retourne l'heure réelle de fin d'émission du dernier envoi (mode entrelacé).
+ * @return Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    virtual uint64_t lastTransmit() const = 0;
+
+/**
+ * Estampille (champ Transmit) puis envoie un paquet NTP.
+ * @param ntp Paquet à envoyer.
+ * @param host Nom ou IP du destinataire.
+ * @param port Port UDP du destinataire.
+ * @return Vrai si le paquet est parti.
+ */
+    virtual bool send(NTP& ntp, const char host[], const uint16_t port) = 0;
+
+/**
+ * Estampille (champ Transmit) puis envoie un paquet NTP.
+ * @param ntp Paquet à envoyer.
+ * @param to Destinataire.
+ * @return Vrai si le paquet est parti.
+ */
+    virtual bool send(NTP& ntp, const Endpoint& to) = 0;
+
+/**
+ * Envoie un datagramme brut (messages de contrôle, paquets déjà estampillés).
+ * @param data Données à envoyer.
+ * @param size Taille des données.
+ * @param to Destinataire.
+ * @return Vrai si le datagramme est parti.
+ */
+    virtual bool send(const uint8_t data[], const size_t size, const Endpoint& to) = 0;
+
+/**
+ * Attend un datagramme et l'estampille à la réception.
+ * @param buffer Tampon recevant les données.
+ * @param size Taille du tampon (le datagramme est tronqué au-delà).
+ * @param from Adresse de l'émetteur.
+ * @param rx Heure de réception en microsecondes depuis le 1er janvier 1900.
+ * @param timeout Attente maximale en millisecondes.
+ * @return La taille lue, ou -1 si rien n'a été reçu.
+ */
+    virtual int receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout = 0) = 0;
+
+/**
+ * Attend un paquet NTP et l'estampille à la réception (T3).
+ * @param ntp Paquet recevant les données.
+ * @param from Adresse de l'émetteur.
+ * @param timeout Attente maximale en millisecondes.
+ * @return Vrai si un paquet complet a été reçu.
+ */
+    bool receive(NTP& ntp, Endpoint& from, const unsigned timeout = 0) {
+      uint8_t buffer[NTP_MAX_PACKET];   // les champs d'extension ne doivent pas tronquer le datagramme.
+      uint64_t rx;
+      const int len = receive(buffer, sizeof(buffer), from, rx, timeout);
+      if (len < NTP::packetSize()) return false;
+      ntp.setPacket(buffer, len);
+      ntp.setT3(rx);
+      return true;
+    }
+
+  protected:
+    Transport() : keys(nullptr), leap(nullptr) {}
+
+/**
+ * Estampille le champ Transmit puis signe le paquet s'il porte un Key ID.
+ * @param ntp Paquet à émettre.
+ */
+    void stamp(NTP& ntp) const {
+      ntp.setT0(now());
+      if (keys && ntp.getKeyId()) keys->sign(ntp);
+    }
+
+/**
+ * Convertit une heure de l'horloge locale en heure publiée.
+ * @param t Le temps en microsecondes depuis le 1er janvier 1900.
+ */
+    uint64_t civil(const uint64_t t) const {
+      return leap ? leap->civil(t) : t;
+    }
+
+    PacketSigner* keys;
+    const Leap* leap;
+};
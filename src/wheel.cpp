@@ -0,0 +1,89 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "wheel.h"
+
+TimerWheel::TimerWheel() :
+  current(0)
+{
+  for (auto& level : slots) {
+    for (auto& head : level) head.prev = head.next = &head;
+  }
+}
+
+void TimerWheel::link(TimerEntry& head, TimerEntry& entry) {
+  entry.prev = head.prev;
+  entry.next = &head;
+  head.prev->next = &entry;
+  head.prev = &entry;
+}
+
+void TimerWheel::insert(TimerEntry& entry) {
+  const uint32_t delta = entry.expiry - current;
+  uint8_t level = 0;
+  while ((level < WHEEL_LEVELS - 1) && (delta >> (WHEEL_BITS * (level + 1)))) ++level;
+  link(slots[level][(entry.expiry >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)], entry);
+}
+
+void TimerWheel::schedule(TimerEntry& entry, uint32_t delay) {
+  cancel(entry);
+  if (!delay) delay = 1;
+  if (delay >= WHEEL_SPAN) delay = WHEEL_SPAN - 1;
+  entry.expiry = current + delay;
+  insert(entry);
+}
+
+void TimerWheel::cancel(TimerEntry& entry) {
+  if (!entry.isPending()) return;
+  entry.prev->next = entry.next;
+  entry.next->prev = entry.prev;
+  entry.prev = entry.next = nullptr;
+}
+
+void TimerWheel::cascade(const uint8_t level) {
+  TimerEntry& head = slots[level][(current >> (WHEEL_BITS * level)) & (WHEEL_SLOTS - 1)];
+  while (head.next != &head) {
+    TimerEntry& entry = *head.next;
+    cancel(entry);
+    insert(entry);
+  }
+}
+
+void TimerWheel::advance(const uint32_t ticks) {
+  for (uint32_t i = 0; i < ticks; ++i) {
+    ++current;
+    for (uint8_t level = 1; level < WHEEL_LEVELS; ++level) {  // les niveaux supérieurs redescendent au passage.
+      if (current & ((1UL << (WHEEL_BITS * level)) - 1)) break;
+      cascade(level);
+    }
+
+    TimerEntry due;  // la case est détachée : les rappels peuvent replanifier ou annuler librement.
+    TimerEntry& head = slots[0][current & (WHEEL_SLOTS - 1)];
+    if (head.next == &head) continue;
+    due.next = head.next;
+    due.prev = head.prev;
+    due.next->prev = &due;
+    due.prev->next = &due;
+    head.prev = head.next = &head;
+
+    while (due.next != &due) {
+      TimerEntry& entry = *due.next;
+      cancel(entry);
+      if (entry.callback) entry.callback(entry);
+    }
+  }
+}
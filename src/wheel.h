@@ -0,0 +1,105 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include <cstdint>
+
+#define WHEEL_BITS   6                                // Cases par niveau : 2^WHEEL_BITS.
+#define WHEEL_SLOTS  (1U << WHEEL_BITS)
+#define WHEEL_LEVELS 4                                // Portée : 2^(WHEEL_BITS x WHEEL_LEVELS) tics.
+#define WHEEL_SPAN   (1UL << (WHEEL_BITS * WHEEL_LEVELS))
+
+/**
+ * Tâche planifiée dans une TimerWheel. L'entrée appartient à l'appelant (aucune allocation) et doit rester
+ * en place tant qu'elle est planifiée.
+ */
+struct TimerEntry {
+  TimerEntry(void (*aCallback)(TimerEntry&) = nullptr, void* aContext = nullptr) :
+    callback(aCallback), context(aContext), prev(nullptr), next(nullptr), expiry(0) {}
+
+/**
+ * Indique que l'entrée est planifiée.
+ */
+  bool isPending() const { return next; }
+
+  void (*callback)(TimerEntry&);  // Appelé à l'échéance ; peut replanifier l'entrée.
+  void* context;                  // Libre pour l'appelant.
+
+  TimerEntry* prev;               // Liste chaînée de la case (réservé à TimerWheel).
+  TimerEntry* next;
+  uint32_t    expiry;             // Echéance [tics].
+};
+
+/**
+ * Roue de temporisation hiérarchique (timing wheel) : WHEEL_LEVELS niveaux de WHEEL_SLOTS cases, chaque niveau
+ * couvrant WHEEL_SLOTS fois la portée du précédent. Une entrée est rangée au niveau de son délai, puis
+ * redescendue (cascade) quand le niveau inférieur atteint sa case. Planification et annulation en O(1),
+ * avance en O(1) amorti par tic.
+ *
+ * La roue ne lit aucune horloge : advance() est appelé par l'application (une fois par seconde sur l'ESP32),
+ * ou par une horloge simulée sur la version hôte pour des essais déterministes.
+ */
+class TimerWheel {
+  public:
+/**
+ * Public constructor.
+ */
+    TimerWheel();
+
+/**
+ * Planifie (ou replanifie) une entrée.
+ * @param entry Entrée ; annulée d'abord si elle était planifiée.
+ * @param delay Délai [tics], 1 au moins, borné à WHEEL_SPAN - 1.
+ */
+    void schedule(TimerEntry& entry, uint32_t delay);
+
+/**
+ * Annule une entrée (sans effet si elle n'est pas planifiée).
+ */
+    void cancel(TimerEntry& entry);
+
+/**
+ * Avance la roue et appelle les entrées échues, dans l'ordre des échéances.
+ * @param ticks Nombre de tics écoulés.
+ */
+    void advance(const uint32_t ticks = 1);
+
+/**
+ * Retourne le temps courant de la roue [tics].
+ */
+    uint32_t now() const { return current; }
+
+  private:
+/**
+ * Range une entrée dans la case de son échéance.
+ */
+    void insert(TimerEntry& entry);
+
+/**
+ * Chaîne une entrée en fin de liste.
+ */
+    static void link(TimerEntry& head, TimerEntry& entry);
+
+/**
+ * Redescend les entrées d'une case d'un niveau supérieur.
+ */
+    void cascade(const uint8_t level);
+
+    TimerEntry slots[WHEEL_LEVELS][WHEEL_SLOTS];  // Têtes de listes circulaires.
+    uint32_t   current;
+};
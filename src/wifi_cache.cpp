@@ -0,0 +1,78 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#include "wifi_cache.h"
+
+#include <cstring>
+
+static void putAddr(uint8_t* p, const uint32_t v) {
+  memcpy(p, &v, 4);   // déjà en ordre réseau.
+}
+
+static uint32_t getAddr(const uint8_t* p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+static bool same(const WiFiLease& a, const WiFiLease& b) {
+  return !memcmp(a.bssid, b.bssid, 6) && (a.channel == b.channel) && (a.ip == b.ip) && (a.gateway == b.gateway)
+    && (a.netmask == b.netmask) && (a.dns == b.dns);
+}
+
+bool WiFiCache::load(WiFiLease& lease) {
+  uint8_t data[WIFI_CACHE_SIZE];
+  if (!store.load(data, sizeof(data))) return false;
+  if (memcmp(data, "WIFI", 4) || (data[4] != WIFI_CACHE_VERSION)) return false;
+  const uint8_t* const c = data + WIFI_CACHE_SIZE - 4;
+  const uint32_t crc = (uint32_t(c[0]) << 24) | (uint32_t(c[1]) << 16) | (uint32_t(c[2]) << 8) | c[3];
+  if (crc != DriftFile::crc32(data, WIFI_CACHE_SIZE - 4)) return false;
+
+  lease.channel = data[5];
+  memcpy(lease.bssid, data + 6, 6);
+  lease.ip = getAddr(data + 12);
+  lease.gateway = getAddr(data + 16);
+  lease.netmask = getAddr(data + 20);
+  lease.dns = getAddr(data + 24);
+  last = lease;
+  valid = true;
+  return true;
+}
+
+bool WiFiCache::save(const WiFiLease& lease) {
+  if (valid && same(lease, last)) return false;   // ménage la flash.
+
+  uint8_t data[WIFI_CACHE_SIZE] = {};
+  memcpy(data, "WIFI", 4);
+  data[4] = WIFI_CACHE_VERSION;
+  data[5] = lease.channel;
+  memcpy(data + 6, lease.bssid, 6);
+  putAddr(data + 12, lease.ip);
+  putAddr(data + 16, lease.gateway);
+  putAddr(data + 20, lease.netmask);
+  putAddr(data + 24, lease.dns);
+  const uint32_t crc = DriftFile::crc32(data, WIFI_CACHE_SIZE - 4);
+  data[WIFI_CACHE_SIZE - 4] = crc >> 24;
+  data[WIFI_CACHE_SIZE - 3] = crc >> 16;
+  data[WIFI_CACHE_SIZE - 2] = crc >> 8;
+  data[WIFI_CACHE_SIZE - 1] = crc;
+
+  if (!store.store(data, sizeof(data))) return false;
+  last = lease;
+  valid = true;
+  return true;
+}
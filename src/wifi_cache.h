@@ -0,0 +1,69 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+
+#pragma once
+
+#include "drift.h"
+
+#define WIFI_CACHE_VERSION 1
+#define WIFI_CACHE_SIZE    32   // Taille de l'enregistrement sérialisé [octets].
+
+/**
+ * Dernière association réussie : point d'accès, canal et bail DHCP (adresses IPv4 en ordre réseau).
+ */
+struct WiFiLease {
+  uint8_t  bssid[6];
+  uint8_t  channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t netmask;
+  uint32_t dns;
+};
+
+/**
+ * Cache de la dernière association, pour une reconnexion directe (sans balayage des canaux ni DHCP).
+ *
+ * Format : "WIFI", version, canal, BSSID, IP, passerelle, masque, DNS, CRC-32 ; l'enregistrement n'est
+ * réécrit que s'il a changé.
+ */
+class WiFiCache {
+  public:
+/**
+ * Public constructor.
+ * @param aStore Support de l'enregistrement.
+ */
+    WiFiCache(DriftStore& aStore) : store(aStore), last(), valid(false) {}
+
+/**
+ * Lit et vérifie l'enregistrement.
+ * @param lease Reçoit la dernière association.
+ * @return Faux si l'enregistrement est absent, d'une autre version ou corrompu.
+ */
+    bool load(WiFiLease& lease);
+
+/**
+ * Ecrit l'association si elle diffère de celle enregistrée.
+ * @param lease Association réussie.
+ * @return Vrai si l'enregistrement a été écrit.
+ */
+    bool save(const WiFiLease& lease);
+
+  private:
+    DriftStore& store;
+    WiFiLease   last;     // Dernière association lue ou écrite.
+    bool        valid;
+};
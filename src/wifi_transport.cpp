@@ -0,0 +1,33 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#include "wifi_transport.h"
+
+int WiFiTransport::receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout) {
+  const auto start = millis();
+  while (udp.parsePacket() <= 0) {
+    if (millis() - start >= timeout) return -1; // timedout without packet.
+    yield();
+  }
+  rx = now();  // stamp as soon as the packet is seen.
+
+  const auto nb = udp.read(buffer, size);
+  if (nb <= 0) return -1; // error reading!
+
+  from.ip = uint32_t(udp.remoteIP());
+  from.port = udp.remotePort();
+  return nb;
+}
@@ -0,0 +1,89 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+#include <WiFiUdp.h>
+#include <ESP32Time.h>
+#include "transport.h"
+
+/**
+ * Transport UDP de l'ESP32 (WiFiUDP), estampillé par l'horloge ESP32Time.
+ */
+class WiFiTransport : public Transport {
+  public:
+/**
+ * Public constructor.
+ * @param aTime Horloge locale utilisée pour les estampilles.
+ */
+    WiFiTransport(ESP32Time& aTime) : time(aTime), udp(), txDone(0) {}
+
+    bool begin(const uint16_t port) override {
+      return udp.begin(port);
+    }
+
+    bool beginMulticast(const char group[], const uint16_t port) override {
+      IPAddress ip;
+      return ip.fromString(group) && udp.beginMulticast(ip, port);
+    }
+
+    uint64_t now() const override {
+      uint64_t t = time.getMicros();
+      t += (time.getEpoch() + YEAR1970) * 1000000ULL;
+      return civil(t);
+    }
+
+    uint64_t lastTransmit() const override {
+      return txDone;
+    }
+
+    bool send(NTP& ntp, const char host[], const uint16_t port) override {
+      if (!udp.beginPacket(host, port)) return false;
+      stamp(ntp);
+      udp.write(ntp.packetAddr(), ntp.length());
+      return endPacket();
+    }
+
+    bool send(NTP& ntp, const Endpoint& to) override {
+      if (!udp.beginPacket(IPAddress(to.ip), to.port)) return false;
+      stamp(ntp);
+      udp.write(ntp.packetAddr(), ntp.length());
+      return endPacket();
+    }
+
+    bool send(const uint8_t data[], const size_t size, const Endpoint& to) override {
+      if (!udp.beginPacket(IPAddress(to.ip), to.port)) return false;
+      udp.write(data, size);
+      return endPacket();
+    }
+
+    using Transport::receive;
+    int receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout = 0) override;
+
+  private:
+/**
+ * Termine l'envoi et note l'heure de retour de lwIP (le datagramme est alors parti vers le pilote WiFi).
+ */
+    bool endPacket() {
+      const bool ok = udp.endPacket();
+      txDone = now();
+      return ok;
+    }
+
+    ESP32Time& time;
+    WiFiUDP udp;
+    uint64_t txDone;
+};
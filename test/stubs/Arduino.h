@@ -0,0 +1,32 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+// Substitut hôte du noyau Arduino : seulement ce qu'utilisent les modules compilés par CMakeLists.txt.
+// Les fonctions sont définies par chaque test qui en a besoin.
+
+#include <cstdint>
+#include <cstddef>
+
+typedef uint8_t byte;
+
+#define LOW    0
+#define HIGH   1
+#define OUTPUT 3
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
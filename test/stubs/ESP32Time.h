@@ -0,0 +1,27 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+#pragma once
+
+// Substitut hôte de la bibliothèque ESP32Time ; les méthodes sont définies par les tests (horloge simulée).
+
+class ESP32Time {
+  public:
+    ESP32Time(unsigned long offset = 0);
+    void setTime(unsigned long epoch, int micros = 0);
+    unsigned long getEpoch();
+    long getMicros();
+};
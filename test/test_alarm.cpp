@@ -0,0 +1,134 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Alarmes planifiées sur une horloge simulée : l'esp_timer et l'horloge disciplinée (ESP32Time) sont remplacés
+// par un temps entier avancé par le test ; le rappel du timer est appelé à son échéance.
+
+#include "check.h"
+#include "alarm.h"
+
+#include <Arduino.h>
+#include <vector>
+
+#define START 1750000000000000ULL   // [µs depuis 1970]
+
+static int64_t  T = 0;              // Temps de l'esp_timer [µs].
+static uint64_t offset = START;     // Horloge disciplinée = offset + T.
+static int64_t  deadline = -1;
+static void   (*expire)(void*) = nullptr;
+static void*    expireArg = nullptr;
+static uint8_t  pins[2];
+
+ESP32Time::ESP32Time(unsigned long) {}
+void ESP32Time::setTime(unsigned long epoch, int micros) { offset = uint64_t(epoch) * 1000000 + micros - T; }
+unsigned long ESP32Time::getEpoch() { return (offset + T) / 1000000; }
+long ESP32Time::getMicros() { return (offset + T) % 1000000; }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t pin, uint8_t level) { if (pin < sizeof(pins)) pins[pin] = level; }
+int64_t esp_timer_get_time() { return T; }
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  expire = args->callback;
+  expireArg = args->arg;
+  *handle = (esp_timer_handle_t)1;
+  return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t timeout) { deadline = T + timeout; return ESP_OK; }
+esp_err_t esp_timer_stop(esp_timer_handle_t) { deadline = -1; return ESP_OK; }
+
+// Avance le temps jusqu'à until [µs d'esp_timer], en déclenchant le timer à chacune de ses échéances.
+static void advance(const int64_t until) {
+  while ((deadline >= 0) && (deadline <= until)) {
+    T = deadline;
+    deadline = -1;
+    expire(expireArg);
+  }
+  T = until;
+}
+
+static std::vector<uint64_t> fired;     // Heure disciplinée de chaque déclenchement.
+static void onAlarm(Alarm&) { fired.push_back(offset + T); }
+
+int main() {
+// Tas : ordre des échéances malgré les annulations.
+  {
+    Alarm* slots[64];
+    Alarm alarms[64];
+    AlarmHeap heap(slots, 64);
+    for (unsigned i = 0; i < 64; ++i) {
+      alarms[i].when = (i * 37) % 64;
+      CHECK(heap.push(alarms[i]));
+    }
+    Alarm extra;
+    CHECK(!heap.push(extra));
+    for (unsigned i = 0; i < 64; i += 3) heap.remove(alarms[i]);
+    heap.remove(alarms[0]);            // déjà retirée : sans effet.
+    uint64_t last = 0;
+    size_t count = 0;
+    while (Alarm* const alarm = heap.pop()) {
+      CHECK(alarm->when >= last);
+      CHECK(!alarm->isPending());
+      last = alarm->when;
+      ++count;
+    }
+    CHECK(count == 64 - 22);
+  }
+
+  Alarm* slots[8];
+  ESP32Time time;
+  AlarmScheduler scheduler(time, slots, 8);
+  CHECK(scheduler.begin());
+
+// Alarme unique avec sortie : déclenchée à l'heure, puis retirée.
+  Alarm once(onAlarm, nullptr, 1, HIGH);
+  CHECK(scheduler.schedule(once, START + 2500000));
+  CHECK((deadline > 0) && (deadline <= ALARM_AHEAD));    // jamais armé plus loin que ALARM_AHEAD.
+  advance(3000000);
+  CHECK(fired.size() == 1);
+  CHECK((fired[0] >= START + 2500000 - ALARM_EARLY) && (fired[0] <= START + 2500000));
+  CHECK(pins[1] == HIGH);
+  CHECK(!once.isPending());
+
+// Alarme périodique : la correction de l'horloge est suivie, l'échéance reste sur l'heure disciplinée.
+  fired.clear();
+  Alarm periodic(onAlarm);
+  CHECK(scheduler.schedule(periodic, START + 10000000, 5));
+  advance(5000000);
+  time.setTime(time.getEpoch(), time.getMicros() + 200000);   // saut de +200 ms.
+  scheduler.rearm();
+  advance(26000000);
+  CHECK(fired.size() == 4);
+  for (size_t i = 0; i < fired.size(); ++i) {
+    const uint64_t due = START + 10000000 + i * 5000000;
+    CHECK((fired[i] + ALARM_EARLY >= due) && (fired[i] <= due));
+  }
+  CHECK(periodic.when == START + 30000000);
+
+// Déclenchement en avance (dans ALARM_EARLY) : l'alarme avance d'une seule période.
+  const unsigned early = scheduler.run(periodic.when - ALARM_EARLY / 2);
+  CHECK(early == 1);
+  CHECK(periodic.when == START + 35000000);
+
+// Périodes manquées : une seule exécution, puis l'échéance suivante après l'heure courante.
+  CHECK(scheduler.run(START + 52500000) == 1);
+  CHECK(periodic.when == START + 55000000);
+
+// Annulation.
+  scheduler.cancel(periodic);
+  CHECK(!periodic.isPending());
+  CHECK(scheduler.size() == 0);
+  CHECK(scheduler.run(START + 100000000) == 0);
+  return failures;
+}
@@ -0,0 +1,96 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Client du mode diffusion en boucle locale : serveur retenu, échange de calibration comme association à part
+// (origine vérifiée, réponse unique), puis offset de chaque paquet diffusé.
+
+#include "check.h"
+#include "broadcast.h"
+#include "linux_transport.h"
+#include "responder.h"
+
+#include <cstdlib>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#define SERVER_PORT 12393
+#define CLIENT_PORT 12394
+#define SKEW        250000    // Avance de l'horloge du serveur [µs].
+
+// Transport dont l'horloge d'émission avance de skew.
+class SkewedTransport : public LinuxTransport {
+  public:
+    SkewedTransport() : skew(0) {}
+    uint64_t now() const override { return LinuxTransport::now() + skew; }
+    int64_t skew;
+};
+
+int main() {
+  SkewedTransport server;
+  server.skew = SKEW;
+  CHECK(server.begin(SERVER_PORT));
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, server.now());
+
+  LinuxTransport transport;
+  CHECK(transport.begin(CLIENT_PORT));
+  BroadcastClient client;
+  const Endpoint to = { htonl(INADDR_LOOPBACK), CLIENT_PORT };
+
+// Premier paquet diffusé : le serveur est retenu, pas encore de calibration.
+  NTP packet = NTP::makeNTP(NTPMODE_BROADCAST);
+  CHECK(responder.broadcast(packet));
+  CHECK(server.send(packet, to));
+  Endpoint from;
+  NTP heard = NTP::makeNTP(NTPMODE_BROADCAST);
+  CHECK(transport.receive(heard, from, 1000));
+  CHECK(client.accept(heard, from));
+  CHECK(!client.isCalibrated());
+  CHECK(!client.accept(heard, Endpoint{ htonl(0x7F000002), SERVER_PORT }));   // autre serveur.
+
+// Une réponse sans requête en cours est ignorée.
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  CHECK(!client.calibrate(reply, from));
+
+// Echange de calibration.
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  CHECK(transport.send(request, Endpoint{ from.ip, SERVER_PORT }));
+  client.sent(request);
+  NTP received = NTP::makeNTP(NTPMODE_CLIENT);
+  Endpoint requester;
+  CHECK(server.receive(received, requester, 1000));
+  received.setT3(received.getT3() + SKEW);    // estampille noyau : hors de l'horloge décalée.
+  CHECK(responder.respond(received, reply));
+  CHECK(server.send(reply, requester));
+  CHECK(transport.receive(reply, from, 1000));
+  CHECK(!client.calibrate(reply, Endpoint{ htonl(0x7F000002), SERVER_PORT }));
+  CHECK(client.calibrate(reply, from));
+  CHECK(client.isCalibrated());
+  CHECK(client.getDelay() < 10000);
+  CHECK(!client.calibrate(reply, from));    // doublon.
+
+// Les paquets diffusés suivants donnent l'avance du serveur.
+  for (int i = 0; i < 5; ++i) {
+    CHECK(responder.broadcast(packet));
+    CHECK(server.send(packet, to));
+    CHECK(transport.receive(heard, from, 1000));
+    CHECK(client.accept(heard, from));
+    CHECK(std::llabs(client.getOffset(heard) - SKEW) < 1000);
+  }
+  return failures;
+}
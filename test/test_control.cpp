@@ -0,0 +1,65 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Réponses READVAR du mode 6 : variables système et variables propres à chaque association.
+
+#include "check.h"
+#include "control.h"
+
+#include <cstring>
+#include <string>
+
+static std::string readVariables(const ControlResponder& control, const uint16_t assoc) {
+  const uint8_t request[12] = { (4 << 3) | 6, 2, 0, 1, 0, 0, uint8_t(assoc >> 8), uint8_t(assoc), 0, 0, 0, 0 };
+  uint8_t reply[CONTROL_SIZE];
+  const size_t size = control.respond(request, sizeof(request), reply);
+  if ((size < 12) || (reply[1] & 0x40)) return "";
+  return std::string((const char*)reply + 12, (reply[10] << 8) | reply[11]);
+}
+
+int main() {
+  SyncSnapshot s = {};
+  s.stratum = 2;
+  s.poll = 6;
+  s.assocs = 2;
+  memcpy(s.assoc[0].address, "\x0a\0\0\x01", 4);
+  s.assoc[0].stratum = 1;
+  s.assoc[0].hpoll = 6;
+  s.assoc[0].ppoll = 10;
+  s.assoc[0].selected = true;
+  memcpy(s.assoc[1].address, "\x0a\0\0\x02", 4);
+  s.assoc[1].stratum = 3;
+  s.assoc[1].hpoll = 6;
+  s.assoc[1].ppoll = 4;
+
+  ControlResponder control;
+  control.publish(s);
+
+  const auto system = readVariables(control, 0);
+  CHECK(system.find("stratum=2") != std::string::npos);
+  CHECK(system.find("tc=6") != std::string::npos);
+
+  const auto first = readVariables(control, 1);
+  CHECK(first.find("srcadr=10.0.0.1") != std::string::npos);
+  CHECK(first.find("hpoll=6, ppoll=10") != std::string::npos);
+
+  const auto second = readVariables(control, 2);
+  CHECK(second.find("srcadr=10.0.0.2") != std::string::npos);
+  CHECK(second.find("stratum=3, hpoll=6, ppoll=4") != std::string::npos);
+
+  CHECK(readVariables(control, 3).empty());   // association inconnue.
+  return failures;
+}
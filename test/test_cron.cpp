@@ -0,0 +1,87 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Expressions cron autour des changements d'heure 2026 du fuseau de application.cpp (heure du changement en UTC) :
+// le 29 mars à 02:00 UTC (03:00 -> 04:00 locale) et le 25 octobre à 03:00 UTC (05:00 -> 04:00 locale).
+
+#include "check.h"
+#include "cron.h"
+
+#include <cstdlib>
+
+static TimeChangeRule frSTD = {"CET", Last, Sun, Mar, 2, +120};
+static TimeChangeRule frDST = {"CEST", Last, Sun, Oct, 3, +60};
+static const Timezone paris(frSTD, frDST);
+
+#define SPRING 1774749600   // 2026-03-29 02:00 UTC
+#define AUTUMN 1792897200   // 2026-10-25 03:00 UTC
+#define HOUR   3600
+
+int main() {
+  setenv("TZ", "UTC", 1);   // Timezone calcule les changements avec mktime(), en UTC comme sur l'ESP32.
+  tzset();
+
+  CronExpression cron;
+  CHECK(!cron.compile("* * * *"));
+  CHECK(!cron.compile("60 * * * *"));
+  CHECK(cron.compile("30 7 * * MON-FRI"));
+  CHECK(cron.nextLocal(SPRING) == 1774855800);              // lundi 30 mars, 07:30 locale.
+
+// Printemps : 03:30 locale n'existe pas, l'alarme a lieu au changement d'heure, puis le lendemain à 03:30 CEST.
+  CHECK(cron.compile("30 3 * * *"));
+  time_t t = cron.nextFire(SPRING - 24 * HOUR, paris);
+  CHECK(t == SPRING - 24 * HOUR + 30 * 60);                 // samedi 03:30 CET = 02:30 UTC.
+  t = cron.nextFire(t, paris);
+  CHECK(t == SPRING);
+  t = cron.nextFire(t, paris);
+  CHECK(t == SPRING + 24 * HOUR - 30 * 60);                 // lundi 03:30 CEST = 01:30 UTC.
+
+// Plusieurs minutes sautées : une seule occurrence au changement d'heure.
+  CHECK(cron.compile("0,30 3 * * *"));
+  t = cron.nextFire(SPRING - HOUR, paris);
+  CHECK(t == SPRING);
+  CHECK(cron.nextFire(t, paris) > SPRING + 12 * HOUR);
+
+// Heures * : l'expression suit le temps écoulé, sans trou au printemps.
+  CHECK(cron.compile("*/30 * * * *"));
+  t = SPRING - HOUR;
+  for (int i = 0; i < 6; ++i) {
+    const time_t next = cron.nextFire(t, paris);
+    CHECK(next == t + 30 * 60);
+    t = next;
+  }
+
+// Automne : 04:15 locale existe deux fois, l'alarme n'a lieu qu'à la première (CEST), puis le lendemain (CET).
+  CHECK(cron.compile("15 4 * * *"));
+  t = cron.nextFire(AUTUMN - 2 * HOUR, paris);
+  CHECK(t == AUTUMN - 45 * 60);                             // 04:15 CEST = 02:15 UTC.
+  t = cron.nextFire(t, paris);
+  CHECK(t == AUTUMN + 24 * HOUR + 15 * 60);                 // lundi 04:15 CET = 03:15 UTC.
+
+// Heures * : l'heure répétée a lieu deux fois, toutes les 30 minutes du temps écoulé.
+  CHECK(cron.compile("*/30 * * * *"));
+  t = AUTUMN - 2 * HOUR;
+  for (int i = 0; i < 8; ++i) {
+    const time_t next = cron.nextFire(t, paris);
+    CHECK(next == t + 30 * 60);
+    t = next;
+  }
+
+// Sans occurrence (30 février).
+  CHECK(cron.compile("0 0 30 2 *"));
+  CHECK(cron.nextFire(SPRING, paris) == 0);
+  return failures;
+}
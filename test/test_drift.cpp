@@ -0,0 +1,107 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// DriftFile sur un FileStore : aller-retour de l'enregistrement, rejet d'un fichier corrompu, tronqué ou d'une
+// autre version, et espacement des écritures.
+
+#include "check.h"
+#include "drift.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#define INTERVAL 3600
+
+// Modifie un octet du fichier.
+static void patch(const char path[], const long offset, const uint8_t value) {
+  FILE* const f = fopen(path, "r+b");
+  fseek(f, offset, SEEK_SET);
+  fputc(value, f);
+  fclose(f);
+}
+
+int main() {
+  CHECK(DriftFile::crc32((const uint8_t*)"123456789", 9) == 0xCBF43926);   // valeur de contrôle CRC-32.
+
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/test_drift.%d", int(getpid()));
+  remove(path);
+
+  FileStore store(path);
+  DriftFile drift(store, INTERVAL);
+  DriftRecord record = {};
+  CHECK(!drift.load(record));
+
+// Aller-retour : la fréquence est arrondie au 1/65536 ppm.
+  DriftRecord saved = {};
+  saved.frequency = -12.3456;
+  saved.epoch = 1790000000;
+  saved.count = 2;
+  memcpy(saved.servers[0].ip, "\xC0\xA8\x01\x01", 4);
+  saved.servers[0].poll = 1024;
+  memcpy(saved.servers[1].ip, "\x0A\x00\x00\x02", 4);
+  saved.servers[1].denied = true;
+  saved.servers[1].poll = 64;
+  CHECK(drift.save(saved));
+
+  CHECK(drift.load(record));
+  CHECK(fabs(record.frequency - saved.frequency) <= 1.0 / 65536);
+  CHECK(record.epoch == saved.epoch);
+  CHECK(record.count == 2);
+  CHECK(!memcmp(record.servers[0].ip, saved.servers[0].ip, 4));
+  CHECK(!record.servers[0].denied && (record.servers[0].poll == 1024));
+  CHECK(!memcmp(record.servers[1].ip, saved.servers[1].ip, 4));
+  CHECK(record.servers[1].denied && (record.servers[1].poll == 64));
+
+// Espacement : pas de nouvelle écriture avant INTERVAL, sauf si forcée.
+  saved.frequency = 3.5;
+  saved.epoch += INTERVAL - 1;
+  CHECK(!drift.save(saved));
+  CHECK(drift.load(record) && (record.frequency != 3.5));
+  CHECK(drift.save(saved, true));
+  CHECK(drift.load(record) && (record.frequency == 3.5));
+  saved.epoch += INTERVAL - 1;
+  CHECK(!drift.save(saved));
+  saved.epoch += 1;
+  CHECK(drift.save(saved));
+
+// Un nouvel objet (redémarrage) écrit sans attendre.
+  DriftFile restarted(store, INTERVAL);
+  CHECK(restarted.save(saved));
+
+// Un octet modifié : le CRC ne correspond plus.
+  patch(path, 9, 0x55);
+  CHECK(!drift.load(record));
+  CHECK(drift.save(saved, true));
+  CHECK(drift.load(record));
+
+// Autre version.
+  patch(path, 4, DRIFT_VERSION + 1);
+  CHECK(!drift.load(record));
+
+// Fichier tronqué, puis trop long.
+  CHECK(drift.save(saved, true));
+  CHECK(!truncate(path, DRIFT_SIZE - 1));
+  CHECK(!drift.load(record));
+  CHECK(drift.save(saved, true));
+  CHECK(!truncate(path, DRIFT_SIZE + 1));
+  CHECK(!drift.load(record));
+
+  remove(path);
+  return failures;
+}
@@ -0,0 +1,84 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Champs d'extension NTPv4 (RFC 7822) : construction puis parcours, MAC final, champs mal formés.
+
+#include "check.h"
+#include "extension.h"
+
+int main() {
+  uint8_t packet[NTP_MAX_PACKET];
+  const NTP ntp = NTP::makeNTP(NTPMODE_CLIENT);
+  const uint8_t value[40] = { 1, 2, 3 };
+
+  ExtensionBuilder builder(packet, sizeof(packet));
+  builder.header(ntp);
+  CHECK(builder.add(0x0104, value, 32));
+  CHECK(builder.add(0x0204, value, 5));          // complété à 8 octets, puis à 16 (taille minimale).
+  const size_t len = builder.finish();
+  CHECK(len == size_t(NTP::packetSize()) + 36 + EXT_LAST_LENGTH);
+
+  ExtensionIterator it(packet, len);
+  ExtensionField field;
+  CHECK(it.next(field) && (field.type == 0x0104) && (field.valueLength() == 32) && (field.value[2] == 3));
+  CHECK(it.next(field) && (field.type == 0x0204) && (field.length == EXT_LAST_LENGTH));
+  CHECK(!it.next(field));
+  CHECK(it.isValid());
+  CHECK(it.offset() == len);
+
+// Un MAC (Key ID + SHA-1) après les champs n'est pas pris pour un champ.
+  memset(packet + len, 0xAB, 24);
+  ExtensionIterator withMac(packet, len + 24);
+  int fields = 0;
+  while (withMac.next(field)) ++fields;
+  CHECK(fields == 2);
+  CHECK(withMac.isValid());
+  CHECK(withMac.offset() == len);
+
+// Paquet sans champ : seulement l'entête, ou l'entête et un MAC.
+  ExtensionIterator bare(packet, NTP::packetSize());
+  CHECK(!bare.next(field) && bare.isValid());
+  ExtensionIterator bareMac(packet, NTP::packetSize() + 20);
+  CHECK(!bareMac.next(field) && bareMac.isValid());
+
+// Longueurs mal formées : trop courte, non multiple de 4, au-delà du datagramme.
+  const uint16_t lengths[] = { 8, 18, 200 };
+  for (const uint16_t length : lengths) {
+    packet[NTP::packetSize() + 2] = length >> 8;
+    packet[NTP::packetSize() + 3] = length & 0xFF;
+    ExtensionIterator bad(packet, len);
+    CHECK(!bad.next(field));
+    CHECK(!bad.isValid());
+  }
+
+// Champs chiffrés de NTS : pas de MAC possible, un petit champ final reste un champ.
+  uint8_t plain[64];
+  ExtensionBuilder inner(plain, sizeof(plain), 0);
+  CHECK(inner.add(0x0204, value, 12));
+  ExtensionIterator cookies(plain, inner.size(), 0, false);
+  CHECK(cookies.next(field) && (field.type == 0x0204));
+  CHECK(!cookies.next(field) && cookies.isValid());
+
+// Sans MAC possible, un reste de 1 à 3 octets est mal formé : l'entête du champ n'est pas lu au-delà.
+  for (size_t extra = 1; extra < 4; ++extra) {
+    ExtensionIterator tail(plain, inner.size() + extra, 0, false);
+    CHECK(tail.next(field));
+    CHECK(!tail.next(field));
+    CHECK(!tail.isValid());
+    CHECK(tail.offset() == inner.size());
+  }
+  return failures;
+}
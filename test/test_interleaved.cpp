@@ -0,0 +1,152 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Mode entrelacé en boucle locale, serveur et client sur la même horloge : le client estampille Transmit puis
+// tarde LATE µs avant l'envoi (comme le calcul du MAC de NTS). La mesure simple est décalée de LATE / 2, la
+// mesure entrelacée (émission réelle) ne l'est pas. Une correction de l'horloge du client entre l'échange et
+// sa mesure entrelacée doit être retranchée de l'offset.
+
+#include "check.h"
+#include "interleaved.h"
+#include "linux_transport.h"
+#include "responder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#define SERVER_PORT 12403
+#define CLIENT_PORT 12404
+#define LATE        4000      // Retard de l'envoi sur l'estampille Transmit [µs].
+#define SLEW        50000     // Correction appliquée à l'horloge du client [µs].
+#define EXCHANGES   21
+
+// Horloge du client décalée de skew : émission, fin d'émission et réception.
+class SkewedTransport : public LinuxTransport {
+  public:
+    using LinuxTransport::receive;
+    SkewedTransport() : skew(0) {}
+    uint64_t now() const override { return LinuxTransport::now() + skew; }
+    uint64_t lastTransmit() const override { return LinuxTransport::lastTransmit() + skew; }
+    int receive(uint8_t buffer[], const size_t size, Endpoint& from, uint64_t& rx, const unsigned timeout = 0) override {
+      const int len = LinuxTransport::receive(buffer, size, from, rx, timeout);
+      rx += skew;
+      return len;
+    }
+    int64_t skew;
+};
+
+static std::atomic<bool> running(true);
+
+// Serveur comme Application::serveNTP() : réponse entrelacée si la requête le demande.
+static void serve(LinuxTransport& transport, const Responder& responder) {
+  InterleavedServer interleaved;
+  while (running) {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    Endpoint from;
+    if (!transport.receive(request, from, 20)) continue;
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    if (!responder.respond(request, reply)) continue;
+    if (interleaved.prepare(from, request, reply)) transport.send(reply.packetAddr(), reply.length(), from);
+    else transport.send(reply, from);
+    interleaved.sent(from, reply, transport.lastTransmit());
+  }
+}
+
+// Un échange : Transmit estampillé LATE µs avant l'envoi, comme Application::pollNts().
+static bool exchange(SkewedTransport& transport, InterleavedClient& client, const int64_t corrections, NTP& reply) {
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  client.prepare(request);
+  request.setT0(transport.now());
+  usleep(LATE);
+  if (!transport.send(request.packetAddr(), request.length(), Endpoint{ htonl(INADDR_LOOPBACK), SERVER_PORT })) return false;
+  client.sent(request, transport.lastTransmit());
+  Endpoint from;
+  return transport.receive(reply, from, 1000) && client.receive(reply, corrections) && (reply.check() == NTP_CHECK_OK);
+}
+
+static int64_t median(std::vector<int64_t> v) {
+  std::sort(v.begin(), v.end());
+  return v.empty() ? 0 : v[v.size() / 2];
+}
+
+int main() {
+  LinuxTransport server;
+  CHECK(server.begin(SERVER_PORT));
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, server.now());
+  std::thread thread(serve, std::ref(server), std::cref(responder));
+
+  SkewedTransport transport;
+  CHECK(transport.begin(CLIENT_PORT));
+  InterleavedClient client;
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+
+// Mode simple : chaque échange repart de zéro.
+  std::vector<int64_t> basic;
+  for (int i = 0; i < EXCHANGES; ++i) {
+    client.reset();
+    CHECK(exchange(transport, client, 0, reply));
+    CHECK(!client.isInterleaved());
+    basic.push_back(client.getOffset(reply));
+  }
+
+// Mode entrelacé : à partir du second échange, la mesure porte sur l'échange précédent.
+  std::vector<int64_t> interleaved;
+  client.reset();
+  CHECK(exchange(transport, client, 0, reply));
+  for (int i = 0; i < EXCHANGES; ++i) {
+    CHECK(exchange(transport, client, 0, reply));
+    CHECK(client.isInterleaved());
+    interleaved.push_back(client.getOffset(reply));
+  }
+  std::printf("median offset: basic %lld us, interleaved %lld us (T0 %d us early)\n",
+    (long long)median(basic), (long long)median(interleaved), LATE);
+  CHECK(std::llabs(median(basic) - LATE / 2) < LATE / 4);
+  CHECK(std::llabs(median(interleaved)) < LATE / 8);
+  CHECK(std::llabs(median(interleaved)) < std::llabs(median(basic)) / 4);
+
+// Correction de l'horloge entre un échange et sa mesure entrelacée : l'horloge avance de SLEW, l'offset courant
+// devient -SLEW. La réponse suivante mesure encore l'horloge d'avant la correction.
+  int64_t corrections = 0;
+  transport.skew += SLEW;
+  corrections += SLEW;
+  CHECK(exchange(transport, client, corrections, reply));
+  CHECK(client.isInterleaved());
+  CHECK(std::llabs(reply.getOffset()) < LATE / 8);                   // mesure de l'échange d'avant la correction.
+  CHECK(std::llabs(client.getOffset(reply) + SLEW) < LATE / 8);      // ramenée à l'horloge actuelle.
+  CHECK(exchange(transport, client, corrections, reply));
+  CHECK(std::llabs(reply.getOffset() + SLEW) < LATE / 8);            // l'échange mesuré suit la correction.
+  CHECK(std::llabs(client.getOffset(reply) + SLEW) < LATE / 8);
+
+// reset() (saut d'horloge) : retour au mode simple, sans correction en attente.
+  client.reset();
+  CHECK(exchange(transport, client, corrections, reply));
+  CHECK(!client.isInterleaved());
+  CHECK(client.getOffset(reply) == reply.getOffset());
+
+  running = false;
+  thread.join();
+  return failures;
+}
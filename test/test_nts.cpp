@@ -0,0 +1,144 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// NtsClient contre le serveur NTS local (NtsStandInServer) : établissement de clés sur TCP, puis échanges NTP
+// authentifiés sur UDP par LinuxTransport, renouvellement des cookies et rejet d'une réponse altérée.
+
+#include "check.h"
+#include "linux_nts.h"
+#include "linux_transport.h"
+#include "responder.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define KE_PORT 14460
+#define NTP_PORT 12383
+#define CLIENT_PORT 12384
+
+static const uint8_t psk[16] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+static const uint8_t master[32] = { 0x42 };
+static std::atomic<bool> running(true);
+
+static int listenTcp(const uint16_t port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  const int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || listen(fd, 1)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static void serveKe(const int listener, NtsStandInServer& server, bool& ok) {
+  StandInChannel channel(psk, accept(listener, nullptr, nullptr));
+  ok = server.exchange(channel);
+}
+
+static void serveNtp(LinuxTransport& transport, const Responder& responder, NtsStandInServer& server) {
+  uint8_t buffer[NTP_MAX_PACKET];
+  uint8_t out[NTP_MAX_PACKET];
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  while (running) {
+    Endpoint from;
+    uint64_t rx;
+    const int len = transport.receive(buffer, sizeof(buffer), from, rx, 20);
+    if (len < NTP::packetSize()) continue;
+    request.setPacket(buffer);
+    request.setT3(rx);
+    if (!responder.respond(request, reply)) continue;
+    reply.setT0(transport.now());
+    const size_t size = server.respond(buffer, len, reply, out);
+    if (size) transport.send(out, size, from);
+  }
+}
+
+int main() {
+  NtsStandInServer server(master);
+  const int listener = listenTcp(KE_PORT);
+  CHECK(listener >= 0);
+  bool served = false;
+  std::thread ke(serveKe, listener, std::ref(server), std::ref(served));
+
+  NtsClient client;
+  CHECK(!client.isReady());
+  StandInChannel channel(psk);
+  CHECK(channel.connect("127.0.0.1", KE_PORT));
+  CHECK(client.exchange(channel));
+  ke.join();
+  close(listener);
+  CHECK(served);
+  CHECK(client.isReady());
+  CHECK(client.getCookies() == NTS_COOKIES);
+
+  LinuxTransport serverTransport;
+  CHECK(serverTransport.begin(NTP_PORT));
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, serverTransport.now());
+  std::thread ntp(serveNtp, std::ref(serverTransport), std::cref(responder), std::ref(server));
+
+  LinuxTransport transport;
+  CHECK(transport.begin(CLIENT_PORT));
+  const Endpoint to = { htonl(INADDR_LOOPBACK), NTP_PORT };
+  uint8_t buffer[NTP_MAX_PACKET];
+  uint8_t tampered[NTP_MAX_PACKET];
+  int tamperedLen = 0;
+  for (int i = 0; i < 3 * NTS_COOKIES; ++i) {    // bien plus d'échanges que de cookies : chaque réponse en rend un.
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    request.setT0(transport.now());
+    const size_t size = client.prepare(request, buffer);
+    CHECK(size > NTP::packetSize());
+    CHECK(transport.send(buffer, size, to));
+
+    Endpoint from;
+    uint64_t rx;
+    const int len = transport.receive(buffer, sizeof(buffer), from, rx, 1000);
+    CHECK(len > NTP::packetSize());
+    if (len <= NTP::packetSize()) continue;
+    memcpy(tampered, buffer, len);
+    tamperedLen = len;
+    CHECK(client.verify(buffer, len));
+
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    reply.setPacket(buffer);
+    reply.setT3(rx);
+    CHECK(reply.getT0() == request.getT2());
+    CHECK(std::llabs(reply.getOffset()) < 1000);
+    CHECK(client.getCookies() == NTS_COOKIES);
+  }
+
+// Réponse altérée (Transmit modifié) : l'authentificateur ne la couvre plus.
+  tampered[43] ^= 0x01;
+  CHECK(!client.verify(tampered, tamperedLen));
+  CHECK(client.isReady());
+
+  running = false;
+  ntp.join();
+  return failures;
+}
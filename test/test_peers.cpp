@@ -0,0 +1,105 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// Trois horloges en associations symétriques sur la boucle locale, chacune sur son port et décalée d'un offset
+// connu : chaque pair doit devenir joignable et mesurer l'écart de l'autre.
+
+#include "check.h"
+#include "linux_transport.h"
+#include "peer.h"
+#include "responder.h"
+
+#include <cstdlib>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#define NODES 3
+#define BASE_PORT 12370
+
+/**
+ * Transport dont l'horloge avance de skew : estampilles d'émission (now) et de réception (T3).
+ */
+class SkewedTransport : public LinuxTransport {
+  public:
+    SkewedTransport() : skew(0) {}
+    uint64_t now() const override { return LinuxTransport::now() + skew; }
+    int64_t skew;
+};
+
+struct Node {
+  SkewedTransport transport;
+  Responder responder;
+  Peer peers[NODES];
+};
+
+static void poll(Node& node) {
+  for (auto& peer : node.peers) {
+    if (!peer.isConfigured()) continue;
+    NTP ntp = NTP::makeNTP(NTPMODE_SYMMETRIC_ACTIVE);
+    node.responder.symmetric(ntp, NTPMODE_SYMMETRIC_ACTIVE);
+    peer.prepare(ntp);
+    if (node.transport.send(ntp, peer.getAddress())) peer.sent(ntp);
+  }
+}
+
+static unsigned drain(Node& node) {
+  unsigned measures = 0;
+  NTP ntp = NTP::makeNTP(NTPMODE_SYMMETRIC_ACTIVE);
+  Endpoint from;
+  while (node.transport.receive(ntp, from, 20)) {
+    ntp.setT3(ntp.getT3() + node.transport.skew);
+    for (auto& peer : node.peers) {   // toutes les instances partagent 127.0.0.1 : le port les distingue.
+      if (peer.isConfigured() && (peer.getAddress().port == from.port) && peer.receive(ntp)) ++measures;
+    }
+  }
+  return measures;
+}
+
+int main() {
+  static Node nodes[NODES];
+  const int64_t skews[NODES] = { 0, 5000, -3000 };
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  for (int i = 0; i < NODES; ++i) {
+    CHECK(nodes[i].transport.begin(BASE_PORT + i));
+    nodes[i].transport.skew = skews[i];
+    nodes[i].responder.update(upstream, "\x7f\0\0\x01", 6, nodes[i].transport.now());
+    for (int j = 0; j < NODES; ++j) {
+      if (j != i) nodes[i].peers[j].configure(Endpoint{ htonl(INADDR_LOOPBACK), uint16_t(BASE_PORT + j) });
+    }
+  }
+
+  unsigned measures = 0;
+  for (int round = 0; round < 4; ++round) {
+    for (auto& node : nodes) {   // les pairs s'interrogent à tour de rôle, comme avec des phases de poll différentes.
+      poll(node);
+      for (auto& other : nodes) measures += drain(other);
+    }
+  }
+  CHECK(measures >= NODES * (NODES - 1));
+
+  for (int i = 0; i < NODES; ++i) {
+    for (int j = 0; j < NODES; ++j) {
+      if (j == i) continue;
+      const Peer& peer = nodes[i].peers[j];
+      CHECK(peer.isReachable());
+      CHECK(peer.getStratum() == 2);
+      CHECK(std::llabs(peer.getOffset() - (skews[j] - skews[i])) < 1000);
+      CHECK(peer.getDelay() < 10000);
+    }
+  }
+  return failures;
+}
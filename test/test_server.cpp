@@ -0,0 +1,105 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// LinuxServer sur la boucle locale : réponses servies, requêtes signées rejetées, KoD comptés à part.
+
+#include "check.h"
+#include "linux_server.h"
+
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define SERVER_PORT 12353
+
+static int fd = -1;
+
+static bool exchange(const uint8_t data[], const size_t size, NTP& reply) {
+  if (send(fd, data, size, 0) != ssize_t(size)) return false;
+  struct pollfd pfd = { fd, POLLIN, 0 };
+  if (poll(&pfd, 1, 100) <= 0) return false;
+  uint8_t buffer[NTP_MAX_PACKET];
+  if (recv(fd, buffer, sizeof(buffer), 0) != NTP::packetSize()) return false;
+  reply.setPacket(buffer);
+  return true;
+}
+
+static bool exchange(const NTP& request, NTP& reply) {
+  return exchange(request.packetAddr(), request.length(), reply);
+}
+
+int main() {
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, (uint64_t(time(nullptr)) + YEAR1970) * 1000000ULL);
+
+  LinuxServer server(responder, 2);
+  CHECK(server.start(SERVER_PORT));
+
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(SERVER_PORT);
+  CHECK(!connect(fd, (struct sockaddr*)&addr, sizeof(addr)));
+
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+  request.setT0((uint64_t(time(nullptr)) + YEAR1970) * 1000000ULL);
+  CHECK(exchange(request, reply));
+  CHECK(reply.getStratum() == 2);
+  CHECK(reply.getT0() == request.getT2());
+
+// Insertion annoncée : le LI des réponses suit le Leap publié avec le répondeur.
+  Leap leap(false, false);
+  leap.update(1, time(nullptr));
+  server.update(responder, &leap);
+  CHECK(exchange(request, reply));
+  CHECK(reply.getLeap() == 1);
+  server.update(responder);
+  CHECK(exchange(request, reply));
+  CHECK(reply.getLeap() == 0);
+
+// Requête signée (Key ID + SHA-1) : le serveur n'a pas de trousseau, elle est rejetée sans réponse.
+  uint8_t signedRequest[NTP_MAX_PACKET];
+  memcpy(signedRequest, request.packetAddr(), NTP::packetSize());
+  memset(signedRequest + NTP::packetSize(), 0x5A, 24);
+  CHECK(!exchange(signedRequest, NTP::packetSize() + 24, reply));
+
+// Rafale : les requêtes au-delà du seau donnent un seul KoD RATE, puis sont ignorées.
+  unsigned answers = 3, kods = 0;
+  for (int i = 0; i < 16; ++i) {
+    if (!exchange(request, reply)) continue;
+    if (reply.getStratum()) ++answers;
+    else ++kods;
+  }
+  CHECK(kods == 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  CHECK(server.served() == answers);
+  CHECK(server.kissed() == kods);
+  CHECK(server.rejected() == 1 + 16 - (answers - 3) - kods);
+  CHECK(server.dropped() == 0);
+  server.stop();
+  close(fd);
+  return failures;
+}
@@ -0,0 +1,77 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// SpscQueue : file pleine et vide sur un seul thread, puis un producteur et un consommateur concurrents qui
+// échangent une séquence numérotée (ordre, aucune perte, aucun élément lu à moitié écrit).
+
+#include "check.h"
+#include "spsc.h"
+
+#include <cstdint>
+#include <thread>
+
+#define COUNT 1000000
+
+struct Item {
+  uint64_t seq;
+  uint64_t check;   // ~seq : détecte une case lue avant d'être publiée.
+};
+
+int main() {
+// File pleine : la N+1e poussée échoue, l'ordre est conservé après le retour au début du tampon.
+  SpscQueue<int, 4> small;
+  int value;
+  CHECK(!small.pop(value));
+  for (int i = 0; i < 4; ++i) CHECK(small.push(i));
+  CHECK(!small.push(4));
+  CHECK(small.pop(value) && (value == 0));
+  CHECK(small.push(4));
+  CHECK(!small.push(5));
+  for (int i = 1; i <= 4; ++i) CHECK(small.pop(value) && (value == i));
+  CHECK(!small.pop(value));
+
+// Producteur et consommateur concurrents.
+  static SpscQueue<Item, 64> queue;
+  unsigned long full = 0;
+  std::thread producer([&full]() {
+    for (uint64_t seq = 0; seq < COUNT; ++seq) {
+      const Item item = { seq, ~seq };
+      while (!queue.push(item)) {
+        ++full;
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  uint64_t expected = 0;
+  unsigned long disorder = 0;
+  Item item;
+  while (expected < COUNT) {
+    if (!queue.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if ((item.seq != expected) || (item.check != ~item.seq)) ++disorder;
+    expected = item.seq + 1;
+  }
+  producer.join();
+
+  CHECK(disorder == 0);
+  CHECK(expected == COUNT);
+  CHECK(!queue.pop(item));
+  std::printf("%d éléments, file pleine %lu fois\n", COUNT, full);
+  return failures;
+}
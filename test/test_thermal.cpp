@@ -0,0 +1,102 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// ThermalModel appris sur une source de température simulée (cycle jour / nuit de 5 à 45 °C) et un quartz de
+// loi f(T) connue, mesuré avec du bruit : les coefficients ajustés et la fréquence prédite doivent converger.
+
+#include "check.h"
+#include "thermal.h"
+
+#include <cmath>
+#include <random>
+
+#define A  8.0      // [ppm] à 25 °C
+#define B  0.12     // [ppm/°C]
+#define C  -0.035   // [ppm/°C²]
+
+static double law(const double celsius) {
+  const double x = celsius - THERMAL_CENTER;
+  return A + B * x + C * x * x;
+}
+
+// Température d'une sinusoïde de période 96 mesures entre 5 et 45 °C.
+class FakeTemperature : public TemperatureSource {
+  public:
+    FakeTemperature() : step(0) {}
+
+    bool read(float& celsius) override {
+      celsius = 25 + 20 * sin(2 * M_PI * step++ / 96);
+      return true;
+    }
+
+  private:
+    unsigned step;
+};
+
+// Ecart maximal entre la prédiction et la loi sur la plage observée.
+static double worst(const ThermalModel& model) {
+  double error = 0;
+  for (float celsius = 6; celsius <= 44; celsius += 1) {
+    double ppm;
+    if (!model.predict(celsius, ppm)) return INFINITY;
+    error = fmax(error, fabs(ppm - law(celsius)));
+  }
+  return error;
+}
+
+int main() {
+  FakeTemperature source;
+  ThermalModel model;
+  std::mt19937 rng(1);
+  std::normal_distribution<double> noise(0, 0.05);    // bruit de mesure de la fréquence [ppm].
+
+  double ppm;
+  CHECK(!model.predict(25, ppm));
+  float celsius;
+  for (int i = 0; i < 3; ++i) {
+    CHECK(source.read(celsius));
+    model.learn(celsius, law(celsius) + noise(rng));
+  }
+  CHECK(model.predict(25, ppm));
+
+  for (int i = 3; i < 48; ++i) {
+    source.read(celsius);
+    model.learn(celsius, law(celsius) + noise(rng));
+  }
+  const double early = worst(model);
+
+  for (int i = 48; i < 2000; ++i) {
+    source.read(celsius);
+    model.learn(celsius, law(celsius) + noise(rng));
+  }
+  CHECK(model.getBuckets() == 17);     // 5..45 °C par tranches de 2,5 °C.
+
+  double a, b, c;
+  model.getFit(a, b, c);
+  CHECK(fabs(a - A) < 0.05);
+  CHECK(fabs(b - B) < 0.005);
+  CHECK(fabs(c - C) < 0.001);
+
+  const double late = worst(model);
+  CHECK(late < 0.1);
+  CHECK(late <= early);
+
+// Hors de la plage observée, la prédiction reste celle de la borne.
+  double above, below;
+  CHECK(model.predict(60, ppm) && model.predict(100, above) && (ppm == above));
+  CHECK(model.predict(-5, ppm) && model.predict(-20, below) && (ppm == below));
+  return failures;
+}
@@ -0,0 +1,101 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// TickScheduler sur une horloge simulée, comme test_alarm : le tic tombe sur le début de chaque seconde de
+// l'horloge disciplinée, un déclenchement en avance (horloge reculée par une correction) est réarmé sans appeler
+// le rappel, un déclenchement en retard l'appelle une seule fois.
+
+#include "check.h"
+#include "tick.h"
+
+#include <vector>
+
+#define START 1750000000250000ULL   // [µs depuis 1970], au quart de la seconde.
+
+static int64_t  T = 0;              // Temps de l'esp_timer [µs].
+static uint64_t offset = START;     // Horloge disciplinée = offset + T.
+static int64_t  deadline = -1;
+static void   (*expire)(void*) = nullptr;
+static void*    expireArg = nullptr;
+static unsigned arms = 0;
+static bool     refuse = false;
+
+ESP32Time::ESP32Time(unsigned long) {}
+void ESP32Time::setTime(unsigned long epoch, int micros) { offset = uint64_t(epoch) * 1000000 + micros - T; }
+unsigned long ESP32Time::getEpoch() { return (offset + T) / 1000000; }
+long ESP32Time::getMicros() { return (offset + T) % 1000000; }
+int64_t esp_timer_get_time() { return T; }
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  if (refuse) return -1;
+  expire = args->callback;
+  expireArg = args->arg;
+  *handle = (esp_timer_handle_t)1;
+  return ESP_OK;
+}
+esp_err_t esp_timer_start_once(esp_timer_handle_t, uint64_t timeout) { deadline = T + timeout; ++arms; return ESP_OK; }
+esp_err_t esp_timer_stop(esp_timer_handle_t) { deadline = -1; return ESP_OK; }
+
+// Avance le temps jusqu'à until [µs d'esp_timer], en déclenchant le timer à chacune de ses échéances.
+static void advance(const int64_t until) {
+  while ((deadline >= 0) && (deadline <= until)) {
+    T = deadline;
+    deadline = -1;
+    expire(expireArg);
+  }
+  T = until;
+}
+
+static std::vector<uint64_t> ticks;     // Heure disciplinée de chaque rappel.
+static void onTick(void*) { ticks.push_back(offset + T); }
+
+// Décale l'horloge disciplinée, comme une correction de phase de l'application [µs].
+static void shift(const int64_t micros) { offset += micros; }
+
+int main() {
+  ESP32Time time;
+  refuse = true;
+  TickScheduler failed(time, onTick, nullptr);
+  CHECK(!failed.begin());
+  CHECK(deadline < 0);
+  refuse = false;
+
+// Premier tic au début de la seconde suivante, puis un par seconde.
+  TickScheduler tick(time, onTick, nullptr);
+  CHECK(tick.begin());
+  CHECK(deadline == 750000);
+  advance(10000000);
+  CHECK(ticks.size() == 10);
+  for (size_t i = 0; i < ticks.size(); ++i) CHECK(ticks[i] == (START / 1000000 + 1 + i) * 1000000);
+  CHECK(arms == 11);
+
+// Horloge reculée de 300 µs : le timer se déclenche à 999700, en avance ; il est réarmé pour 300 µs et le
+// rappel n'est appelé qu'au début de la seconde.
+  ticks.clear();
+  shift(-300);
+  arms = 0;
+  advance(11000000);
+  CHECK(ticks.size() == 1);
+  CHECK(!ticks.empty() && (ticks[0] % 1000000 == 0));
+  CHECK(arms == 2);
+
+// Horloge avancée de 200 ms : le tic suivant arrive en retard mais une seule fois, puis se recale.
+  ticks.clear();
+  shift(200000);
+  advance(13000000);
+  CHECK(ticks.size() == 2);
+  CHECK((ticks.size() == 2) && (ticks[0] % 1000000 == 200000) && (ticks[1] - ticks[0] == 800000));
+  return failures;
+}
@@ -0,0 +1,92 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// LinuxTransport sur la boucle locale : échange client/serveur estampillé par le noyau, estampille d'émission
+// relue sans attente et réception qui ne reste pas bloquée par la seule file d'erreurs.
+
+#include "check.h"
+#include "linux_transport.h"
+#include "responder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+#define SERVER_PORT 12323
+#define CLIENT_PORT 12324
+
+static std::atomic<bool> running(true);
+
+static void serve(LinuxTransport& transport, const Responder& responder) {
+  while (running) {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    Endpoint from;
+    if (!transport.receive(request, from, 20)) continue;
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    if (responder.respond(request, reply)) transport.send(reply, from);
+  }
+}
+
+int main() {
+  LinuxTransport server;
+  CHECK(server.begin(SERVER_PORT));
+  CHECK(server.kernelStamps());
+
+  Responder responder;
+  NTP upstream = NTP::makeNTP(NTPMODE_SERVER);
+  upstream.setClock(1, 6, LOCAL_PRECISION, "GPS");
+  responder.update(upstream, "\x7f\0\0\x01", 6, server.now());
+  std::thread thread(serve, std::ref(server), std::cref(responder));
+
+  LinuxTransport client;
+  CHECK(client.begin(CLIENT_PORT));
+  CHECK(client.kernelStamps());
+
+  for (int i = 0; i < 10; ++i) {
+    NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+    CHECK(client.send(request, "127.0.0.1", SERVER_PORT));
+    const uint64_t t0 = request.getT2();
+    const uint64_t tx = client.lastTransmit();
+    CHECK(tx >= t0);
+
+    NTP reply = NTP::makeNTP(NTPMODE_SERVER);
+    Endpoint from;
+    CHECK(client.receive(reply, from, 1000));
+    CHECK(from.port == SERVER_PORT);
+    CHECK(reply.getT0() == t0);                       // Origin = Transmit de la requête.
+    CHECK(reply.getT3() >= reply.getT2());
+    CHECK(std::llabs(reply.getOffset()) < 1000);      // même horloge des deux côtés.
+    CHECK(reply.getRTT() < 100000);
+    CHECK(client.lastTransmit() <= reply.getT3());
+  }
+
+// Une estampille d'émission non lue lève POLLERR sans datagramme : la réception doit expirer normalement.
+  NTP request = NTP::makeNTP(NTPMODE_CLIENT);
+  CHECK(client.send(request, "127.0.0.1", SERVER_PORT + 2));
+  uint8_t buffer[NTP_MAX_PACKET];
+  Endpoint from;
+  uint64_t rx;
+  const auto start = std::chrono::steady_clock::now();
+  CHECK(client.receive(buffer, sizeof(buffer), from, rx, 50) < 0);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(elapsed >= std::chrono::milliseconds(45));
+  CHECK(elapsed < std::chrono::milliseconds(500));
+
+  running = false;
+  thread.join();
+  return failures;
+}
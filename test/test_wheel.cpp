@@ -0,0 +1,129 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// TimerWheel avancée tic par tic : échéances sur les frontières de cascade (multiples de 64, 4096, 2^18),
+// délais bornés à WHEEL_SPAN - 1, et rappels qui replanifient ou annulent des entrées pendant advance().
+
+#include "check.h"
+#include "wheel.h"
+
+#include <vector>
+
+static TimerWheel wheel;
+static std::vector<uint32_t> fired;    // Tic de chaque rappel.
+
+static void onFire(TimerEntry&) { fired.push_back(wheel.now()); }
+
+// Avance tic par tic jusqu'à until.
+static void runTo(const uint32_t until) {
+  while (wheel.now() < until) wheel.advance();
+}
+
+// Rappel périodique : se replanifie tous les 10 tics.
+static void onPeriodic(TimerEntry& entry) {
+  fired.push_back(wheel.now());
+  wheel.schedule(entry, 10);
+}
+
+// Rappel qui annule l'entrée passée en contexte.
+static void onCancel(TimerEntry& entry) {
+  fired.push_back(wheel.now());
+  wheel.cancel(*(TimerEntry*)entry.context);
+}
+
+// Rappel qui planifie l'entrée passée en contexte au tic suivant.
+static void onChain(TimerEntry& entry) {
+  fired.push_back(wheel.now());
+  wheel.schedule(*(TimerEntry*)entry.context, 1);
+}
+
+int main() {
+// Frontières de cascade : chaque entrée se déclenche exactement à son échéance.
+  const uint32_t expiries[] = { 1, 63, 64, 65, 127, 128, 4095, 4096, 4097, 8192, 262143, 262144, 262145, 300000 };
+  const size_t count = sizeof(expiries) / sizeof(expiries[0]);
+  TimerEntry entries[count];
+  for (size_t i = 0; i < count; ++i) {
+    entries[i].callback = onFire;
+    wheel.schedule(entries[i], expiries[i]);
+    CHECK(entries[i].isPending());
+  }
+  runTo(300000);
+  CHECK(fired.size() == count);
+  for (size_t i = 0; (i < count) && (i < fired.size()); ++i) CHECK(fired[i] == expiries[i]);
+  for (const auto& entry : entries) CHECK(!entry.isPending());
+
+// Même chose depuis un temps qui n'est pas aligné, avec des échéances sur les frontières suivantes.
+  fired.clear();
+  runTo(300037);
+  const uint32_t aligned[] = { 300032 + 64, 300032 + 128, 303104 + 4096, 524288 };
+  for (size_t i = 0; i < 4; ++i) wheel.schedule(entries[i], aligned[i] - wheel.now());
+  runTo(524288);
+  CHECK(fired.size() == 4);
+  for (size_t i = 0; (i < 4) && (i < fired.size()); ++i) CHECK(fired[i] == aligned[i]);
+
+// Délais bornés : 0 devient 1, au-delà de la portée WHEEL_SPAN - 1.
+  fired.clear();
+  TimerEntry soon(onFire), far(onFire);
+  const uint32_t start = wheel.now();
+  wheel.schedule(soon, 0);
+  wheel.schedule(far, WHEEL_SPAN + 1000);
+  runTo(start + WHEEL_SPAN);
+  CHECK(fired.size() == 2);
+  CHECK((fired.size() == 2) && (fired[0] == start + 1) && (fired[1] == start + WHEEL_SPAN - 1));
+
+// Un rappel qui se replanifie.
+  fired.clear();
+  TimerEntry periodic(onPeriodic);
+  const uint32_t base = wheel.now();
+  wheel.schedule(periodic, 10);
+  runTo(base + 1000);
+  CHECK(fired.size() == 100);
+  CHECK(periodic.isPending());
+  wheel.cancel(periodic);
+  CHECK(!periodic.isPending());
+
+// Un rappel qui annule une entrée de la même case, puis une entrée plus lointaine.
+  fired.clear();
+  TimerEntry victim(onFire), later(onFire);
+  TimerEntry killer(onCancel, &victim), killer2(onCancel, &later);
+  const uint32_t t = wheel.now();
+  wheel.schedule(killer, 5);
+  wheel.schedule(victim, 5);
+  wheel.schedule(killer2, 6);
+  wheel.schedule(later, 5000);
+  runTo(t + 6000);
+  CHECK(fired.size() == 2);
+  CHECK(!victim.isPending() && !later.isPending());
+
+// Un rappel qui planifie une entrée au tic suivant : elle n'est pas appelée pendant le même tic.
+  fired.clear();
+  TimerEntry chained(onFire);
+  TimerEntry chain(onChain, &chained);
+  wheel.schedule(chain, 3);
+  const uint32_t c = wheel.now();
+  runTo(c + 3);
+  CHECK(fired.size() == 1);
+  CHECK(chained.isPending());
+  wheel.advance();
+  CHECK((fired.size() == 2) && (fired[1] == c + 4));
+
+// advance(n) équivaut à n tics.
+  fired.clear();
+  wheel.schedule(soon, 4096);
+  wheel.advance(5000);
+  CHECK((fired.size() == 1) && (fired[0] == c + 4 + 4096));
+  return failures;
+}
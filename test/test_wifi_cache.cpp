@@ -0,0 +1,106 @@
+//
+//    Copyright 2024 Marc SIBERT
+//
+//    Licensed under the Apache License, Version 2.0 (the "License");
+//    you may not use this file except in compliance with the License.
+//    You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//    Unless required by applicable law or agreed to in writing, software
+//    distributed under the License is distributed on an "AS IS" BASIS,
+//    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//    See the License for the specific language governing permissions and
+//    limitations under the License.
+//
+
+// WiFiCache sur un DriftStore en mémoire : aller-retour de l'association, écriture seulement si elle change,
+// rejet d'un enregistrement corrompu et nouvel essai après un échec d'écriture.
+
+#include "check.h"
+#include "wifi_cache.h"
+
+#include <cstring>
+
+// Support en mémoire qui compte les écritures et peut les faire échouer.
+class MemoryStore : public DriftStore {
+  public:
+    MemoryStore() : data(), size(0), writes(0), fail(false) {}
+
+    bool load(uint8_t aData[], const size_t aSize) override {
+      if (aSize != size) return false;
+      memcpy(aData, data, size);
+      return true;
+    }
+
+    bool store(const uint8_t aData[], const size_t aSize) override {
+      if (fail || (aSize > sizeof(data))) return false;
+      memcpy(data, aData, aSize);
+      size = aSize;
+      ++writes;
+      return true;
+    }
+
+    uint8_t  data[64];
+    size_t   size;
+    unsigned writes;
+    bool     fail;
+};
+
+static bool equal(const WiFiLease& a, const WiFiLease& b) {
+  return !memcmp(a.bssid, b.bssid, 6) && (a.channel == b.channel) && (a.ip == b.ip) && (a.gateway == b.gateway)
+    && (a.netmask == b.netmask) && (a.dns == b.dns);
+}
+
+int main() {
+  MemoryStore store;
+  WiFiCache cache(store);
+  WiFiLease lease = {};
+  CHECK(!cache.load(lease));
+
+  WiFiLease saved = {};
+  memcpy(saved.bssid, "\x24\x0A\xC4\x12\x34\x56", 6);
+  saved.channel = 11;
+  memcpy(&saved.ip, "\xC0\xA8\x01\x2A", 4);
+  memcpy(&saved.gateway, "\xC0\xA8\x01\x01", 4);
+  memcpy(&saved.netmask, "\xFF\xFF\xFF\x00", 4);
+  memcpy(&saved.dns, "\xC0\xA8\x01\x01", 4);
+  CHECK(cache.save(saved));
+  CHECK(store.writes == 1);
+  CHECK(store.size == WIFI_CACHE_SIZE);
+  CHECK(!memcmp(store.data + 12, "\xC0\xA8\x01\x2A", 4));   // adresses en ordre réseau.
+
+// La même association n'est pas réécrite.
+  CHECK(!cache.save(saved));
+  CHECK(store.writes == 1);
+
+// Redémarrage : l'association relue n'est pas réécrite non plus.
+  WiFiCache restarted(store);
+  CHECK(restarted.load(lease));
+  CHECK(equal(lease, saved));
+  CHECK(!restarted.save(lease));
+  CHECK(store.writes == 1);
+
+// Changement de canal : nouvelle écriture.
+  saved.channel = 6;
+  CHECK(restarted.save(saved));
+  CHECK(store.writes == 2);
+  CHECK(cache.load(lease) && (lease.channel == 6));
+
+// Echec d'écriture : la suivante réessaie.
+  saved.channel = 1;
+  store.fail = true;
+  CHECK(!cache.save(saved));
+  store.fail = false;
+  CHECK(cache.save(saved));
+  CHECK(store.writes == 3);
+
+// Un octet modifié, ou une autre version : rejeté.
+  store.data[13] ^= 0x01;
+  CHECK(!cache.load(lease));
+  store.data[13] ^= 0x01;
+  CHECK(cache.load(lease) && equal(lease, saved));
+  store.data[4] = WIFI_CACHE_VERSION + 1;
+  CHECK(!cache.load(lease));
+  return failures;
+}